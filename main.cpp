@@ -1,17 +1,44 @@
 #include "./src/Timer.h"
 #include "./src/CachePolicy.h"
 #include "./src/LRU/LRUCache.h"
+#include "./src/LRU/StackDistance.h"
 #include "./src/LFU/LFUCache.h"
 #include "./src/ARC/ArcCache.h"
+#include "./src/LIRS/LIRSCache.h"
+#include "./src/S3FIFO/S3FIFOCache.h"
+#include "./src/Tiered/TieredCache.h"
+#include "./src/Static/StaticCache.h"
+#include "./src/Near/NearCache.h"
+#include "./src/HotKey/HotKeyCache.h"
+#include "./src/Adaptive/AdaptiveCache.h"
+#include "./src/Scan/ScanResistantCache.h"
+#include "./src/Loading/LoadingCache.h"
+#include "./src/Shared/SharedLRUCache.h"
+#include "./src/Compressed/CompressedCache.h"
+#include "./src/Memory/CapacityController.h"
+#include "./src/GDSF/GDSFCache.h"
+#include "./src/Sampled/SampledCache.h"
+#include "./src/Workload/Workload.h"
 
 #include <array>
+#include <chrono>
+#include <atomic>
+#include <cstdio>
 #include <string>
+#include <thread>
 #include <vector>
 #include <random>
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
 
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// 各场景使用固定的随机种子，多次运行的结果可以直接对比
+const unsigned int SEED = 20240601;
+
 void printResults(
     const std::string& testName, int capacity, 
     const std::vector<int>& get_operations,
@@ -26,6 +53,10 @@ void printResults(
             names = {"LRU", "LFU", "ARC", "LRU-K"};
         } else if (hits.size() == 5) {
             names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+        } else if (hits.size() == 6) {
+            names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "LIRS"};
+        } else if (hits.size() == 7) {
+            names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "LIRS", "S3-FIFO"};
         }
 
         for (size_t i = 0; i < hits.size(); i++) {
@@ -53,14 +84,15 @@ void testHotDataAccess() {
 
     CacheSpace::LRU_K_Cache<int, std::string> LRU_K(CAPACITY, HOT_KEYS + COLD_KEYS, 2);
     CacheSpace::LFU_Cache<int, std::string> LFU_Aging(CAPACITY, 20000);
+    CacheSpace::LIRS_Cache<int, std::string> LIRS(CAPACITY);
+    CacheSpace::S3FIFO_Cache<int, std::string> S3FIFO(CAPACITY);
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(SEED);
 
-    std::array<CacheSpace::CachePolicy<int, std::string>*, 5> caches = {&LRU, &LFU, &ARC, &LRU_K, &LFU_Aging};
-    std::vector<int> hits (5, 0);
-    std::vector<int> get_operations (5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::array<CacheSpace::CachePolicy<int, std::string>*, 7> caches = {&LRU, &LFU, &ARC, &LRU_K, &LFU_Aging, &LIRS, &S3FIFO};
+    std::vector<int> hits (7, 0);
+    std::vector<int> get_operations (7, 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "LIRS", "S3-FIFO"};
 
         for (int i = 0; i < caches.size(); ++i) {
         // 先预热缓存，插入一些数据
@@ -116,14 +148,15 @@ void testLoopPattern() {
     // - k=2，对于循环访问，这是一个合理的阈值
     CacheSpace::LRU_K_Cache<int, std::string> lruk(CAPACITY, LOOP_SIZE * 2, 2);
     CacheSpace::LFU_Cache<int, std::string> lfuAging(CAPACITY, 3000);
+    CacheSpace::LIRS_Cache<int, std::string> lirs(CAPACITY);
+    CacheSpace::S3FIFO_Cache<int, std::string> s3fifo(CAPACITY);
 
-    std::array<CacheSpace::CachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::array<CacheSpace::CachePolicy<int, std::string>*, 7> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &lirs, &s3fifo};
+    std::vector<int> hits(7, 0);
+    std::vector<int> get_operations(7, 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "LIRS", "S3-FIFO"};
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(SEED);
 
     // 为每种缓存算法运行相同的测试
     for (int i = 0; i < caches.size(); ++i) {
@@ -182,13 +215,14 @@ void testWorkloadShift() {
     CacheSpace::ARC_Cache<int, std::string> arc(CAPACITY);
     CacheSpace::LRU_K_Cache<int, std::string> lruk(CAPACITY, 500, 2);
     CacheSpace::LFU_Cache<int, std::string> lfuAging(CAPACITY, 10000);
+    CacheSpace::LIRS_Cache<int, std::string> lirs(CAPACITY);
+    CacheSpace::S3FIFO_Cache<int, std::string> s3fifo(CAPACITY);
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::array<CacheSpace::CachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::mt19937 gen(SEED);
+    std::array<CacheSpace::CachePolicy<int, std::string>*, 7> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &lirs, &s3fifo};
+    std::vector<int> hits(7, 0);
+    std::vector<int> get_operations(7, 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "LIRS", "S3-FIFO"};
 
     // 为每种缓存算法运行相同的测试
     for (int i = 0; i < caches.size(); ++i) { 
@@ -258,10 +292,974 @@ void testWorkloadShift() {
     printResults("Workload drastic change test", CAPACITY, get_operations, hits);
 }
 
+void testStackDistance() {
+    std::cout << "\n=== Test Scenario 4: One-pass LRU Stack Distance Test ===" << std::endl;
+
+    const int LOOP_SIZE = 500;
+    const int OPERATIONS = 100000;
+    const std::vector<int> CAPACITIES = {10, 50, 100, 250, 500, 750};
+
+    std::mt19937 gen(SEED);
+
+    // 与循环扫描测试相同的访问模式：60%顺序扫描，30%随机跳跃，10%范围外数据
+    std::vector<int> keys;
+    keys.reserve(OPERATIONS);
+    int current_pos = 0;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        if (op % 100 < 60) {
+            keys.push_back(current_pos);
+            current_pos = (current_pos + 1) % LOOP_SIZE;
+        } else if (op % 100 < 90) {
+            keys.push_back(gen() % LOOP_SIZE);
+        } else {
+            keys.push_back(LOOP_SIZE + (gen() % LOOP_SIZE));
+        }
+    }
+
+    // 一次遍历得到所有容量下的命中率
+    Timer timer;
+    CacheSpace::LRU_StackDistance<int> engine;
+    engine.accessAll(keys.begin(), keys.end());
+    double engineTime = timer.elapsed();
+
+    // 与逐容量构建的 LRU_Cache 结果交叉验证（未命中时回填）
+    Timer cacheTimer;
+    bool allMatch = true;
+    for (int capacity : CAPACITIES) {
+        CacheSpace::LRU_Cache<int, int> lru(capacity);
+        uint64_t hits = 0;
+        int value;
+
+        for (int key : keys) {
+            if (lru.get(key, value)) {
+                hits++;
+            } else {
+                lru.put(key, key);
+            }
+        }
+
+        bool match = hits == engine.hits(capacity);
+        allMatch = allMatch && match;
+        std::cout << "Cache size: " << capacity
+                  << " - Stack Distance Hit Rate: " << std::fixed << std::setprecision(2)
+                  << 100.0 * engine.hitRatio(capacity)
+                  << " / LRU Hit Rate: " << 100.0 * hits / keys.size()
+                  << (match ? " (match)" : " (MISMATCH)") << std::endl;
+    }
+
+    std::cout << "Distinct keys: " << engine.distinctKeys()
+              << ", one-pass time: " << engineTime << "ms"
+              << ", per-capacity LRU time: " << cacheTimer.elapsed() << "ms" << std::endl;
+    std::cout << (allMatch ? "All capacities match LRU_Cache" : "Stack distance mismatch detected") << std::endl;
+}
+
+template<typename Cache>
+void runSnapshotRestart(const std::string& name, int capacity, const std::string& path) {
+    const int HOT_KEYS = 20;
+    const int COLD_KEYS = 5000;
+    const int WARMUP_OPERATIONS = 100000;
+    const int MEASURE_OPERATIONS = 2000;
+
+    std::mt19937 gen(SEED);
+    auto nextKey = [&]() {
+        return gen() % 100 < 70 ? gen() % HOT_KEYS : HOT_KEYS + (gen() % COLD_KEYS);
+    };
+
+    // 运行一段时间后保存快照，模拟部署前的进程
+    Cache before(capacity);
+    for (int op = 0; op < WARMUP_OPERATIONS; ++op) {
+        int key = nextKey();
+        std::string result;
+        if (!before.get(key, result)) before.put(key, "value" + std::to_string(key));
+    }
+
+    Timer saveTimer;
+    bool saved = before.saveSnapshot(path);
+    double saveTime = saveTimer.elapsed();
+
+    // 重启后：一个从快照恢复，一个冷启动
+    Cache warm(capacity);
+    Cache cold(capacity);
+    Timer loadTimer;
+    bool loaded = warm.loadSnapshot(path);
+    double loadTime = loadTimer.elapsed();
+
+    int warmHits = 0, coldHits = 0;
+    for (int op = 0; op < MEASURE_OPERATIONS; ++op) {
+        int key = nextKey();
+        std::string result;
+        if (warm.get(key, result)) warmHits++;
+        else warm.put(key, "value" + std::to_string(key));
+        if (cold.get(key, result)) coldHits++;
+        else cold.put(key, "value" + std::to_string(key));
+    }
+    std::remove(path.c_str());
+
+    std::cout << name << " - saved: " << (saved ? "yes" : "no") << " (" << saveTime << "ms)"
+              << ", loaded: " << (loaded ? "yes" : "no") << " (" << loadTime << "ms)" << std::endl;
+    std::cout << "First " << MEASURE_OPERATIONS << " gets - Warm Hit Rate: " << std::fixed << std::setprecision(2)
+              << 100.0 * warmHits / MEASURE_OPERATIONS
+              << " / Cold Hit Rate: " << 100.0 * coldHits / MEASURE_OPERATIONS << std::endl;
+}
+
+void testSnapshotRestart() {
+    std::cout << "\n=== Test Scenario 5: Snapshot Warm Restart Test ===" << std::endl;
+
+    const int CAPACITY = 2000;
+
+    runSnapshotRestart<CacheSpace::LRU_Cache<int, std::string>>("LRU", CAPACITY, "lru.snapshot");
+    runSnapshotRestart<CacheSpace::LFU_Cache<int, std::string>>("LFU", CAPACITY, "lfu.snapshot");
+    runSnapshotRestart<CacheSpace::ARC_Cache<int, std::string>>("ARC", CAPACITY, "arc.snapshot");
+}
+
+void testTieredSpill() {
+    std::cout << "\n=== Test Scenario 6: Memory + Disk Spill Tier Test ===" << std::endl;
+
+    const int CAPACITY = 500;
+    const int KEYS = 5000;            // 工作集是内存容量的10倍
+    const int OPERATIONS = 100000;
+
+    CacheSpace::SpillOptions options;         // 默认在 $TMPDIR 下各建一个独立目录
+    options.segmentBytes = 1 << 20;
+    options.maxSegments = 8;
+
+    CacheSpace::LRU_Cache<int, std::string> lru(CAPACITY);
+    CacheSpace::Tiered_Cache<int, std::string> tiered(options, CAPACITY);
+    CacheSpace::Tiered_Cache<int, std::string, CacheSpace::Hash_LRU_Cache<int, std::string>> shardedTiered(options, CAPACITY, 4);
+
+    std::array<CacheSpace::CachePolicy<int, std::string>*, 3> caches = {&lru, &tiered, &shardedTiered};
+    std::array<std::string, 3> names = {"LRU", "LRU + Disk", "Hash LRU + Disk"};
+
+    std::mt19937 gen(SEED);
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        int hits = 0;
+        Timer timer;
+
+        for (int op = 0; op < OPERATIONS; ++op) {
+            // 70%概率访问前20%的键
+            int key = gen() % 100 < 70 ? gen() % (KEYS / 5) : gen() % KEYS;
+            std::string result;
+
+            if (caches[i]->get(key, result)) {
+                hits++;
+            } else {
+                caches[i]->put(key, "value" + std::to_string(key) + std::string(100, 'x'));
+            }
+        }
+
+        std::cout << names[i] << " - Hit Rate: " << std::fixed << std::setprecision(2)
+                  << 100.0 * hits / OPERATIONS << " (" << timer.elapsed() << "ms)" << std::endl;
+    }
+
+    std::cout << "Disk tier - hits: " << tiered.diskHits() << ", entries: " << tiered.diskEntries()
+              << ", bytes: " << tiered.diskBytes() << std::endl;
+}
+
+void testConcurrentHits() {
+    std::cout << "\n=== Test Scenario 7: Concurrent Read-heavy Throughput Test ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int KEYS = 1000;              // 全部命中，只测量命中路径的扩展性
+    const int OPERATIONS_PER_THREAD = 200000;
+    const int THREADS = std::max(2u, std::thread::hardware_concurrency());
+
+    CacheSpace::LRU_Cache<int, int> lru(CAPACITY);
+    CacheSpace::S3FIFO_Cache<int, int> s3fifo(CAPACITY);
+    std::array<CacheSpace::CachePolicy<int, int>*, 2> caches = {&lru, &s3fifo};
+    std::array<std::string, 2> names = {"LRU", "S3-FIFO"};
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        for (int key = 0; key < KEYS; ++key) caches[i]->put(key, key);
+
+        Timer timer;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&, t]() {
+                std::mt19937 gen(t);
+                int value;
+                for (int op = 0; op < OPERATIONS_PER_THREAD; ++op) {
+                    caches[i]->get(gen() % KEYS, value);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+
+        std::cout << names[i] << " - " << THREADS << " threads, "
+                  << THREADS * OPERATIONS_PER_THREAD << " gets: " << timer.elapsed() << "ms" << std::endl;
+    }
+}
+
+template<typename Cache>
+void runDispatchBenchmark(const std::string& name, Cache& cache, const std::vector<int>& keys) {
+    int hits = 0;
+    int value;
+    Timer timer;
+
+    for (int key : keys) {
+        if (cache.get(key, value)) {
+            hits++;
+        } else {
+            cache.put(key, key);
+        }
+    }
+
+    std::cout << name << " - Hit Rate: " << std::fixed << std::setprecision(2)
+              << 100.0 * hits / keys.size() << " (" << timer.elapsed() << "ms)" << std::endl;
+}
+
+void testStaticDispatch() {
+    std::cout << "\n=== Test Scenario 8: Virtual vs Static Dispatch Test ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int OPERATIONS = 1000000;
+
+    std::mt19937 gen(SEED);
+    std::vector<int> keys;
+    keys.reserve(OPERATIONS);
+    for (int op = 0; op < OPERATIONS; ++op) {
+        keys.push_back(gen() % 100 < 80 ? gen() % CAPACITY : gen() % (CAPACITY * 20));
+    }
+
+    using namespace CacheSpace;
+    LRU_Cache<int, int> lru(CAPACITY);
+    CachePolicy<int, int>* virtualLRU = &lru;
+    StaticCache<LRUCore<int, int>, MutexLock> mutexLRU(CAPACITY);
+    StaticCache<LRUCore<int, int>, SpinLock, CountingStats> spinLRU(CAPACITY);
+    StaticCache<LRUCore<int, int>, NoLock> confinedLRU(CAPACITY);
+    StaticCache<LRUCoreFor<int, int>, MutexLock> flatLRU(CAPACITY);
+    StaticCache<LRUCoreFor<int, int>, NoLock> confinedFlatLRU(CAPACITY);
+    // 未命中的get和随后的put各算一次引用，K=3即第二次未命中时准入
+    StaticCache<LRUCore<int, int>, NoLock, NoStats, AdmitOnKthReference<int, 3>> admittingLRU(CAPACITY);
+    ShardedStaticCache<StaticCache<LRUCore<int, int>, SpinLock>, 8> shardedLRU(CAPACITY);
+
+    runDispatchBenchmark("LRU_Cache via CachePolicy*", *virtualLRU, keys);
+    runDispatchBenchmark("StaticCache<LRUCore, MutexLock>", mutexLRU, keys);
+    runDispatchBenchmark("StaticCache<LRUCore, SpinLock, CountingStats>", spinLRU, keys);
+    runDispatchBenchmark("StaticCache<LRUCore, NoLock>", confinedLRU, keys);
+    runDispatchBenchmark("StaticCache<FlatLRUCore, MutexLock>", flatLRU, keys);
+    runDispatchBenchmark("StaticCache<FlatLRUCore, NoLock>", confinedFlatLRU, keys);
+    runDispatchBenchmark("StaticCache<LRUCore, NoLock, NoStats, AdmitOnKthReference<3>>", admittingLRU, keys);
+    runDispatchBenchmark("ShardedStaticCache<SpinLock, 8 shards>", shardedLRU, keys);
+}
+
+template<typename Cache>
+double runHotKeyReaders(Cache& cache, int threads, int keys, int operations) {
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int value;
+            for (int op = 0; op < operations; ++op) {
+                cache.get(gen() % keys, value);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return timer.elapsed();
+}
+
+void testNearCache() {
+    std::cout << "\n=== Test Scenario 9: Thread-local Near Cache Test ===" << std::endl;
+
+    const int CAPACITY = 10000;
+    const int HOT_KEYS = 200;           // 所有线程反复读取同一小批热点键
+    const int OPERATIONS_PER_THREAD = 500000;
+    const int THREADS = std::max(2u, std::thread::hardware_concurrency());
+
+    CacheSpace::Hash_LRU_Cache<int, int> sharded(CAPACITY, 8);
+    CacheSpace::NearCacheOptions options;
+    options.slots = 512;
+    CacheSpace::Near_Cache<int, int, CacheSpace::Hash_LRU_Cache<int, int>> near(sharded, options);
+    for (int key = 0; key < HOT_KEYS; ++key) near.put(key, key);
+
+    double shardedTime = runHotKeyReaders(sharded, THREADS, HOT_KEYS, OPERATIONS_PER_THREAD);
+    double nearTime = runHotKeyReaders(near, THREADS, HOT_KEYS, OPERATIONS_PER_THREAD);
+
+    std::cout << "Hash_LRU_Cache - " << THREADS << " threads: " << shardedTime << "ms" << std::endl;
+    std::cout << "Near_Cache over Hash_LRU_Cache - " << THREADS << " threads: " << nearTime << "ms" << std::endl;
+
+    // 通过近端缓存写入后，其他线程不得读到旧值
+    std::atomic<int> stale{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < THREADS - 1; ++t) {
+        readers.emplace_back([&]() {
+            int value;
+            while (!done.load()) {
+                int version = near.get(0);
+                if (near.get(1, value) && value < version) stale++;
+            }
+        });
+    }
+    for (int version = 1; version <= 20000; ++version) {
+        near.put(1, version);
+        near.put(0, version);
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    std::cout << "Stale reads after put: " << stale.load() << std::endl;
+}
+
+template<typename Cache>
+double runSkewedReaders(Cache& cache, int threads, int keys, int operations) {
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            int value;
+            for (int op = 0; op < operations; ++op) {
+                // 一半请求落在键0上，其余均匀分布
+                cache.get(gen() % 2 == 0 ? 0 : gen() % keys, value);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return timer.elapsed();
+}
+
+void testHotKeyReplication() {
+    std::cout << "\n=== Test Scenario 10: Hot-key Replication Test ===" << std::endl;
+
+    const int CAPACITY = 10000;
+    const int KEYS = 5000;
+    const int OPERATIONS_PER_THREAD = 500000;
+    const int THREADS = std::max(2u, std::thread::hardware_concurrency());
+
+    CacheSpace::Hash_LRU_Cache<int, int> sharded(CAPACITY, 8);
+    CacheSpace::HotKeyOptions options;
+    options.replicas = THREADS;
+    CacheSpace::HotKey_Cache<int, int, CacheSpace::Hash_LRU_Cache<int, int>> hot(sharded, options);
+    for (int key = 0; key < KEYS; ++key) hot.put(key, key);
+
+    double shardedTime = runSkewedReaders(sharded, THREADS, KEYS, OPERATIONS_PER_THREAD);
+    double hotTime = runSkewedReaders(hot, THREADS, KEYS, OPERATIONS_PER_THREAD);
+
+    std::cout << "Hash_LRU_Cache - " << THREADS << " threads: " << shardedTime << "ms" << std::endl;
+    std::cout << "HotKey_Cache over Hash_LRU_Cache (" << hot.replicaCount() << " replicas) - "
+              << THREADS << " threads: " << hotTime << "ms" << std::endl;
+
+    std::cout << "Hot keys:";
+    for (int key : hot.hotKeys()) std::cout << " " << key;
+    std::cout << std::endl;
+
+    hot.put(0, -1);
+    std::cout << "Replicated value after put: " << hot.get(0) << std::endl;
+}
+
+void testDeferredRelease() {
+    std::cout << "\n=== Test Scenario 11: Deferred Release Test ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int PUTS_PER_THREAD = 20000;
+    const int THREADS = std::max(2u, std::thread::hardware_concurrency());
+    const std::string payload(4096, 'x');   // 大值：释放内存的开销不应落在锁内
+
+    CacheSpace::Hash_LRU_Cache<int, std::string> lru(CAPACITY, 4);
+    CacheSpace::LFU_Cache<int, std::string> lfu(CAPACITY);
+
+    std::atomic<size_t> lruEvicted{0}, lruBatches{0}, lfuEvicted{0};
+    lru.setBatchEvictionListener([&](const std::pair<int, std::string>*, size_t count) {
+        lruEvicted += count;
+        lruBatches++;
+    });
+    lfu.setBatchEvictionListener([&](const std::pair<int, std::string>*, size_t count) {
+        lfuEvicted += count;
+    });
+
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int op = 0; op < PUTS_PER_THREAD; ++op) {
+                int key = t * PUTS_PER_THREAD + op;
+                lru.put(key, payload);
+                lfu.put(key, payload);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    std::cout << THREADS << " threads, " << THREADS * PUTS_PER_THREAD << " puts of 4KB values: "
+              << timer.elapsed() << "ms" << std::endl;
+    std::cout << "LRU evicted (listener): " << lruEvicted.load() << " in " << lruBatches.load() << " batches" << std::endl;
+    std::cout << "LFU evicted (listener): " << lfuEvicted.load() << std::endl;
+}
+
+void testAdaptivePolicy() {
+    std::cout << "\n=== Test Scenario 12: Online Policy Selection Test ===" << std::endl;
+
+    const int CAPACITY = 2000;
+    const int PHASE_LENGTH = 300000;
+
+    // 三个阶段：循环扫描（略大于缓存）、缓慢漂移的热点窗口、热点+大范围随机混合
+    std::mt19937 gen(42);
+    std::vector<int> keys;
+    keys.reserve(PHASE_LENGTH * 3);
+    for (int op = 0; op < PHASE_LENGTH; ++op) keys.push_back(op % (CAPACITY * 6 / 5));
+    for (int op = 0; op < PHASE_LENGTH; ++op) keys.push_back(100000 + op / 100 + gen() % (CAPACITY * 3 / 4));
+    for (int op = 0; op < PHASE_LENGTH; ++op) keys.push_back(gen() % 100 < 70 ? 200000 + gen() % 500 : 300000 + gen() % 50000);
+
+    CacheSpace::Adaptive_Cache<int, int> adaptive(CAPACITY);
+    CacheSpace::LRU_Cache<int, int> lru(CAPACITY);
+    CacheSpace::LFU_Cache<int, int> lfu(CAPACITY);
+    CacheSpace::ARC_Cache<int, int> arc(CAPACITY);
+    std::array<CacheSpace::CachePolicy<int, int>*, 4> caches = {&adaptive, &lru, &lfu, &arc};
+    std::array<std::string, 4> names = {"Adaptive", "LRU", "LFU", "ARC"};
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::array<int, 3> phaseHits = {0, 0, 0};
+        int value;
+        Timer timer;
+        for (size_t op = 0; op < keys.size(); ++op) {
+            if (caches[i]->get(keys[op], value)) {
+                phaseHits[op / PHASE_LENGTH]++;
+            } else {
+                caches[i]->put(keys[op], keys[op]);
+            }
+        }
+
+        std::cout << names[i] << " - Hit Rate per phase:";
+        for (int hits : phaseHits) std::cout << " " << std::fixed << std::setprecision(2) << 100.0 * hits / PHASE_LENGTH;
+        std::cout << " (" << timer.elapsed() << "ms)" << std::endl;
+    }
+
+    std::cout << "Adaptive - final policy: " << adaptive.currentPolicy()
+              << ", switches: " << adaptive.switches() << std::endl;
+}
+
+void testScanResistance() {
+    std::cout << "\n=== Test Scenario 13: Scan Resistance Test ===" << std::endl;
+
+    const int CAPACITY = 50;
+    const int HOT_KEYS = 40;
+    const int SCAN_LENGTH = 500;        // 批处理任务顺序扫描的键数
+    const int ROUNDS = 200;
+    const int HOT_GETS_PER_ROUND = 1000;
+    const int POST_SCAN_GETS = 100;
+
+    CacheSpace::ScanOptions options;
+    options.probationCapacity = 10;
+
+    CacheSpace::LRU_Cache<int, std::string> lru(CAPACITY);
+    CacheSpace::ARC_Cache<int, std::string> arc(CAPACITY);
+    CacheSpace::ScanResistant_Cache<int, std::string> scanLRU(options, CAPACITY - options.probationCapacity);
+    CacheSpace::ScanResistant_Cache<int, std::string, CacheSpace::ARC_Cache<int, std::string>>
+        scanARC(options, CAPACITY - options.probationCapacity);
+    std::array<CacheSpace::CachePolicy<int, std::string>*, 4> caches = {&lru, &arc, &scanLRU, &scanARC};
+    std::array<std::string, 4> names = {"LRU", "ARC", "ScanResistant<LRU>", "ScanResistant<ARC>"};
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::mt19937 gen(7);
+        int hotHits = 0;
+        std::string value;
+
+        for (int round = 0; round < ROUNDS; ++round) {
+            // 白天：热点读取，未命中则回填
+            for (int op = 0; op < HOT_GETS_PER_ROUND; ++op) {
+                int key = gen() % HOT_KEYS;
+                bool hit = caches[i]->get(key, value);
+                // 只统计扫描刚结束后的前100次读取
+                if (hit && round > 0 && op < POST_SCAN_GETS) hotHits++;
+                if (!hit) caches[i]->put(key, "hot" + std::to_string(key));
+            }
+            // 夜间批处理：一次顺序扫描，逐个读取并回填
+            int start = 1000 + (round % 10) * SCAN_LENGTH;
+            for (int key = start; key < start + SCAN_LENGTH; ++key) {
+                if (!caches[i]->get(key, value)) caches[i]->put(key, "scan" + std::to_string(key));
+            }
+        }
+
+        std::cout << names[i] << " - Post-scan Hot Hit Rate: " << std::fixed << std::setprecision(2)
+                  << 100.0 * hotHits / ((ROUNDS - 1) * POST_SCAN_GETS) << std::endl;
+    }
+    std::cout << "ScanResistant<LRU> - scan writes diverted: " << scanLRU.scanWrites()
+              << ", promotions: " << scanLRU.promotions() << std::endl;
+
+    // 冷启动：随机字符串键的未命中率很高，但缓存未满时不应被当成扫描
+    const int COLD_KEYS = 10000;
+    const int COLD_GETS = 200000;
+    CacheSpace::LRU_Cache<std::string, std::string> coldLRU(2 * COLD_KEYS);
+    CacheSpace::ScanResistant_Cache<std::string, std::string> coldScan(options, 2 * COLD_KEYS);
+    std::array<CacheSpace::CachePolicy<std::string, std::string>*, 2> coldCaches = {&coldLRU, &coldScan};
+    std::array<std::string, 2> coldNames = {"LRU", "ScanResistant<LRU>"};
+
+    for (size_t i = 0; i < coldCaches.size(); ++i) {
+        std::mt19937 gen(11);
+        int hits = 0;
+        std::string value;
+        for (int op = 0; op < COLD_GETS; ++op) {
+            std::string key = "user:" + std::to_string(gen() % COLD_KEYS);
+            if (coldCaches[i]->get(key, value)) hits++;
+            else coldCaches[i]->put(key, key);
+        }
+        std::cout << coldNames[i] << " - Cold-start Hit Rate: " << std::fixed << std::setprecision(2)
+                  << 100.0 * hits / COLD_GETS << std::endl;
+    }
+}
+
+void runSequentialReaders(CacheSpace::Loading_Cache<int, std::string>& cache, int threads, int scans, int length) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, t, scans, length]() {
+            std::string value;
+            for (int scan = 0; scan < scans; ++scan) {
+                // 每个线程扫描自己的区间，奇数线程按步长3倒序扫描
+                int base = (t * scans + scan) * length * 4;
+                for (int i = 0; i < length; ++i) {
+                    int key = t % 2 == 0 ? base + i : base + 3 * (length - i);
+                    cache.get(key, value);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+void testSequentialPrefetch() {
+    std::cout << "\n=== Test Scenario 14: Sequential Prefetch Test ===" << std::endl;
+
+    const int CAPACITY = 500;
+    const int SCANS = 10;
+    const int LENGTH = 200;
+    const auto LATENCY = std::chrono::microseconds(200);   // 模拟一次后端往返
+    const int THREADS = std::max(2u, std::thread::hardware_concurrency());
+
+    // 单个读取和批量读取都只付出一次往返延迟
+    auto loader = [LATENCY](const int& key, std::string& value) {
+        std::this_thread::sleep_for(LATENCY);
+        value = "value" + std::to_string(key);
+        return true;
+    };
+    auto batchLoader = [LATENCY](const std::vector<int>& keys, std::vector<std::pair<int, std::string>>& results) {
+        std::this_thread::sleep_for(LATENCY);
+        for (int key : keys) results.emplace_back(key, "value" + std::to_string(key));
+    };
+
+    CacheSpace::LoadingOptions off;
+    off.prefetch.depth = 0;
+    CacheSpace::LoadingOptions on;
+
+    for (const auto& entry : {std::make_pair("No Prefetch", off), std::make_pair("Stride Prefetch", on)}) {
+        CacheSpace::Loading_Cache<int, std::string> cache(loader, batchLoader, entry.second, CAPACITY);
+
+        Timer timer;
+        runSequentialReaders(cache, THREADS, SCANS, LENGTH);
+        double elapsed = timer.elapsed();
+
+        size_t total = static_cast<size_t>(THREADS) * SCANS * LENGTH;
+        std::cout << entry.first << " - Demand loads: " << cache.loads() << "/" << total
+                  << ", prefetched: " << cache.prefetchLoads()
+                  << ", prefetch hits: " << cache.prefetchHits()
+                  << ", time: " << std::fixed << std::setprecision(2) << elapsed << " ms" << std::endl;
+    }
+}
+
+void testSharedMemory() {
+    std::cout << "\n=== Test Scenario 15: Multi-process Shared Memory Test ===" << std::endl;
+
+    const int PROCESSES = 4;
+    const int KEYS_PER_PROCESS = 5000;
+
+    CacheSpace::SharedOptions options;
+    options.name = "/kcache_demo_" + std::to_string(getpid());
+    options.capacity = PROCESSES * KEYS_PER_PROCESS * 5 / 4;   // 给分片不均留出余量
+    options.shards = 16;
+    CacheSpace::Shared_LRU_Cache<int, int>::unlinkSegment(options);
+
+    CacheSpace::Shared_LRU_Cache<int, int> cache(options);
+    std::cout.flush();
+
+    // 每个子进程按名字打开同一段共享内存，写入自己的键区间
+    Timer timer;
+    for (int p = 0; p < PROCESSES; ++p) {
+        if (fork() == 0) {
+            {
+                CacheSpace::Shared_LRU_Cache<int, int> child(options);
+                for (int key = p * KEYS_PER_PROCESS; key < (p + 1) * KEYS_PER_PROCESS; ++key) child.put(key, key * 2);
+            }
+            _exit(0);
+        }
+    }
+    while (wait(nullptr) > 0) {}
+    double writeTime = timer.elapsed();
+
+    int hits = 0;
+    int value;
+    for (int key = 0; key < PROCESSES * KEYS_PER_PROCESS; ++key) {
+        if (cache.get(key, value) && value == key * 2) hits++;
+    }
+    std::cout << "Entries written by " << PROCESSES << " processes and visible to the parent: " << hits << "/"
+              << PROCESSES * KEYS_PER_PROCESS << " (writes took " << writeTime << " ms)" << std::endl;
+
+    // 模拟进程崩溃：子进程在不断写入时被 SIGKILL，可能正持有分片锁
+    int crashes = 0;
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            CacheSpace::Shared_LRU_Cache<int, int> child(options);
+            for (int i = 0;; ++i) child.put(i % (options.capacity * 2), i);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        crashes++;
+
+        // 存活进程照常使用所有分片
+        for (int key = 0; key < 1000; ++key) cache.put(key, key);
+    }
+
+    bool intact = true;
+    for (int key = 0; key < 1000; ++key) intact = intact && cache.get(key, value) && value == key;
+    std::cout << "Writers killed: " << crashes << ", shard locks recovered: " << cache.recoveries()
+              << ", cache usable afterwards: " << (intact ? "yes" : "no") << ", size: " << cache.size() << std::endl;
+
+    CacheSpace::Shared_LRU_Cache<int, int>::unlinkSegment(options);
+}
+
+void testNegativeLookups() {
+    std::cout << "\n=== Test Scenario 16: Negative Lookup Test ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const int EXISTING_KEYS = 2000;     // 后端只有偶数键 [0, 2 * EXISTING_KEYS)
+    const int OPERATIONS = 50000;
+    const auto LATENCY = std::chrono::microseconds(20);
+
+    std::atomic<size_t> backendCalls(0);
+    std::atomic<bool> keyOneCreated(false);
+    auto loader = [&backendCalls, &keyOneCreated, LATENCY](const int& key, std::string& value) {
+        backendCalls++;
+        std::this_thread::sleep_for(LATENCY);
+        if (key == 1 && keyOneCreated) {
+            value = "created";
+            return true;
+        }
+        if (key % 2 != 0 || key >= 2 * EXISTING_KEYS) return false;
+        value = "value" + std::to_string(key);
+        return true;
+    };
+
+    CacheSpace::LoadingOptions without;
+    without.prefetch.depth = 0;
+    CacheSpace::LoadingOptions with = without;
+    with.negative.expectedKeys = 10000;
+    with.negative.falsePositiveRate = 0.001;
+
+    for (const auto& entry : {std::make_pair("No Negative Cache", without), std::make_pair("Bloom Negative Cache", with)}) {
+        CacheSpace::Loading_Cache<int, std::string> cache(loader, nullptr, entry.second, CAPACITY);
+        backendCalls = 0;
+        keyOneCreated = false;
+
+        // 一半请求查询不存在的键（奇数键），集中在少量热点上
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<int> presentDist(0, EXISTING_KEYS - 1);
+        std::uniform_int_distribution<int> absentDist(0, 999);
+        int wrongAbsent = 0;
+        std::string value;
+
+        Timer timer;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            bool present = gen() % 2 == 0;
+            int key = present ? 2 * presentDist(gen) : 2 * absentDist(gen) + 1;
+            if (!cache.get(key, value) && present) wrongAbsent++;
+        }
+        double elapsed = timer.elapsed();
+
+        // 后端新建一个此前被判定为不存在的键并通过 put 写入；
+        // 即使它随后被淘汰出主缓存，也必须重新从后端加载而不是被判为不存在
+        keyOneCreated = true;
+        cache.put(1, "created");
+        for (int key = 0; key < 4 * CAPACITY; key += 2) cache.get(key, value);
+        bool visible = cache.get(1, value) && value == "created";
+
+        std::cout << entry.first << " - backend calls: " << backendCalls
+                  << ", negative hits: " << cache.negativeHits()
+                  << ", existing keys reported absent: " << wrongAbsent
+                  << ", put visible after negative: " << (visible ? "yes" : "no")
+                  << ", time: " << std::fixed << std::setprecision(2) << elapsed << " ms" << std::endl;
+    }
+}
+
+// 模拟业务中常见的 JSON 文本值
+std::string makeProfile(int key) {
+    std::string id = std::to_string(key);
+    return "{\"id\":" + id + ",\"name\":\"user_" + id + "\",\"email\":\"user" + id + "@example.com\","
+           "\"status\":\"active\",\"roles\":[\"reader\",\"writer\"],\"settings\":{\"theme\":\"dark\","
+           "\"language\":\"en-US\",\"notifications\":{\"email\":true,\"sms\":false,\"push\":true}},"
+           "\"address\":{\"city\":\"Springfield\",\"street\":\"" + id + " Main Street\",\"zip\":\"" + id + "\"},"
+           "\"bio\":\"This user has not written a bio yet. This user has not written a bio yet.\"}";
+}
+
+template<typename Cache>
+void runProfileWorkload(const std::string& name, Cache& cache, int keys, int operations) {
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<int> hotDist(0, keys / 5 - 1);
+    std::uniform_int_distribution<int> allDist(0, keys - 1);
+    int hits = 0;
+    std::string value;
+
+    Timer timer;
+    for (int op = 0; op < operations; ++op) {
+        // 80%的请求落在20%的键上
+        int key = gen() % 10 < 8 ? hotDist(gen) : allDist(gen);
+        if (cache.get(key, value)) hits++;
+        else cache.put(key, makeProfile(key));
+    }
+
+    std::cout << name << " - Hit Rate: " << std::fixed << std::setprecision(2) << 100.0 * hits / operations
+              << ", time: " << timer.elapsed() << " ms" << std::endl;
+}
+
+void testCompressedTier() {
+    std::cout << "\n=== Test Scenario 17: Compressed Cold Tier Test ===" << std::endl;
+
+    const size_t BUDGET = 2 << 20;      // 两种缓存占用相同的值内存预算
+    const int KEYS = 40000;
+    const int OPERATIONS = 300000;
+    const size_t valueBytes = makeProfile(KEYS / 2).size();
+
+    int plainCapacity = static_cast<int>(BUDGET / valueBytes);
+    CacheSpace::LRU_Cache<int, std::string> plain(plainCapacity);
+    runProfileWorkload("LRU (" + std::to_string(plainCapacity) + " entries)", plain, KEYS, OPERATIONS);
+
+    // 四分之一预算给未压缩的热数据，其余给压缩冷数据
+    CacheSpace::CompressedOptions options;
+    options.coldBytes = BUDGET * 3 / 4;
+    int hotCapacity = plainCapacity / 4;
+
+    CacheSpace::Compressed_Cache<int> compressedLRU(options, hotCapacity);
+    runProfileWorkload("Compressed<LRU>", compressedLRU, KEYS, OPERATIONS);
+    std::cout << "  cold entries: " << compressedLRU.coldEntries() << ", cold hits: " << compressedLRU.coldHits()
+              << ", compression: " << compressedLRU.coldRawBytes() << " -> " << compressedLRU.coldBytes() << " bytes" << std::endl;
+
+    CacheSpace::Compressed_Cache<int, CacheSpace::LFU_Cache<int, std::string>> compressedLFU(options, hotCapacity);
+    runProfileWorkload("Compressed<LFU>", compressedLFU, KEYS, OPERATIONS);
+    std::cout << "  cold entries: " << compressedLFU.coldEntries() << ", cold hits: " << compressedLFU.coldHits()
+              << ", compression: " << compressedLFU.coldRawBytes() << " -> " << compressedLFU.coldBytes() << " bytes" << std::endl;
+}
+
+// 填满缓存后缩容到十分之一：setCapacity 只改上限，多出的条目由之后每次 put 顺带淘汰
+// 统计缩容到位所需的 put 次数和单次 put 的最大耗时，再扩容回原大小
+template<typename Cache>
+void runResize(const std::string& name, Cache& cache, int capacity) {
+    int next = 0;
+    for (; next < capacity; next++) cache.put(next, next);
+    size_t filled = cache.size();
+
+    auto start = std::chrono::steady_clock::now();
+    cache.setCapacity(capacity / 10);
+    auto resizeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    int puts = 0;
+    long long maxPutUs = 0;
+    while (cache.size() > static_cast<size_t>(capacity / 10) && puts < capacity) {
+        auto begin = std::chrono::steady_clock::now();
+        cache.put(next, next);
+        maxPutUs = std::max<long long>(maxPutUs, std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+        next++;
+        puts++;
+    }
+    size_t shrunk = cache.size();
+
+    cache.setCapacity(capacity);
+    for (int i = 0; i < capacity; i++, next++) cache.put(next, next);
+
+    std::cout << std::left << std::setw(9) << name << std::right
+              << " size " << filled << " -> " << shrunk << " after " << puts << " puts"
+              << ", setCapacity: " << resizeUs << " us, max put: " << maxPutUs << " us"
+              << ", regrown to " << cache.size() << std::endl;
+}
+
+void testOnlineResize() {
+    std::cout << "\n=== Test Scenario 18: Online Capacity Resize Test ===" << std::endl;
+
+    const int CAPACITY = 40000;
+    const int SHARDS = 4;
+
+    CacheSpace::LRU_Cache<int, int> lru(CAPACITY);
+    CacheSpace::Hash_LRU_Cache<int, int> hashLru(CAPACITY, SHARDS);
+    CacheSpace::Hash_LFU_Cache<int, int> hashLfu(CAPACITY, SHARDS);
+    CacheSpace::ARC_Cache<int, int> arc(CAPACITY);
+    CacheSpace::Hash_LIRS_Cache<int, int> hashLirs(CAPACITY, SHARDS);
+    CacheSpace::Hash_S3FIFO_Cache<int, int> hashS3fifo(CAPACITY, SHARDS);
+    CacheSpace::Hash_Sampled_Cache<int, int> hashSampled(CAPACITY, SHARDS);
+
+    runResize("LRU", lru, CAPACITY);
+    runResize("Hash_LRU", hashLru, CAPACITY);
+    runResize("Hash_LFU", hashLfu, CAPACITY);
+    runResize("ARC", arc, CAPACITY);
+    runResize("Hash_LIRS", hashLirs, CAPACITY);
+    runResize("Hash_S3", hashS3fifo, CAPACITY);
+    runResize("Hash_Smp", hashSampled, CAPACITY);
+}
+
+void reportPressure(const std::string& phase, CacheSpace::Capacity_Controller& controller,
+                    CacheSpace::Hash_LRU_Cache<int, std::string>& cache) {
+    uint64_t used, limit;
+    controller.measure(used, limit);
+    std::cout << std::left << std::setw(16) << phase << std::right
+              << " RSS " << (used >> 20) << " / " << (limit >> 20) << " MB"
+              << ", capacity " << cache.capacity() << ", size " << cache.size() << std::endl;
+}
+
+// 以当前 RSS 加 160MB 作为内存上限，缓存的最大容量约 240MB；
+// 控制器每写入一批数据检查一次内存，中途再占用并释放一块与缓存无关的内存
+void testMemoryPressure() {
+    std::cout << "\n=== Test Scenario 19: Memory Pressure Controller Test ===" << std::endl;
+
+    const size_t VALUE_BYTES = 1024;
+    const size_t MAX_CAPACITY = 200000;
+    const int BATCH = 10000;
+    const size_t BALLAST_BYTES = 48 << 20;
+
+    CacheSpace::PressureOptions options;
+    options.limitBytes = CacheSpace::MemoryProbe().read().rssBytes + (160 << 20);
+    CacheSpace::Capacity_Controller controller(options);
+
+    CacheSpace::Hash_LRU_Cache<int, std::string> cache(MAX_CAPACITY, 4);
+    controller.registerCache(cache, 1000, MAX_CAPACITY, VALUE_BYTES + 160);
+
+    int next = 0;
+    auto writeBatches = [&](int batches) {
+        for (int b = 0; b < batches; b++) {
+            for (int i = 0; i < BATCH; i++, next++) cache.put(next, std::string(VALUE_BYTES, 'a' + next % 26));
+            controller.tick();
+        }
+    };
+
+    writeBatches(25);
+    reportPressure("filled", controller, cache);
+
+    std::vector<char> ballast(BALLAST_BYTES, 1);
+    writeBatches(5);
+    reportPressure("+48 MB elsewhere", controller, cache);
+
+    std::vector<char>().swap(ballast);
+    writeBatches(10);
+    reportPressure("released", controller, cache);
+    std::cout << "shrink steps: " << controller.shrinks() << ", grow steps: " << controller.grows() << std::endl;
+}
+
+// 重新计算代价：十分之一的键是昂贵的聚合查询（代价 50），其余是普通查询（代价 1）
+double recomputeCost(uint64_t key) {
+    return key % 10 == 0 ? 50.0 : 1.0;
+}
+
+// 未命中时按代价回源后写入缓存，统计命中率和总回源代价
+template<typename Cache, typename Put>
+void runCostWorkload(const std::string& name, Cache& cache, Put put, uint64_t keys, int operations) {
+    CacheSpace::ScrambledZipfianKeys generator(keys, 0.9, SEED);
+    int hits = 0;
+    double missCost = 0;
+    int value;
+
+    Timer timer;
+    for (int op = 0; op < operations; ++op) {
+        uint64_t key = generator.next();
+        if (cache.get(static_cast<int>(key), value)) {
+            hits++;
+        } else {
+            missCost += recomputeCost(key);
+            put(cache, static_cast<int>(key), static_cast<int>(key));
+        }
+    }
+
+    std::cout << std::left << std::setw(5) << name << std::right
+              << " - Hit Rate: " << std::fixed << std::setprecision(2) << 100.0 * hits / operations
+              << "%, recompute cost: " << std::setprecision(0) << missCost
+              << ", time: " << std::setprecision(2) << timer.elapsed() << " ms" << std::endl;
+}
+
+void testCostAwareEviction() {
+    std::cout << "\n=== Test Scenario 20: Cost-aware Eviction Test ===" << std::endl;
+
+    const int CAPACITY = 1000;
+    const uint64_t KEYS = 20000;
+    const int OPERATIONS = 300000;
+
+    auto plainPut = [](auto& cache, int key, int value) { cache.put(key, value); };
+    auto costPut = [](auto& cache, int key, int value) { cache.put(key, value, recomputeCost(key), 1); };
+
+    CacheSpace::LRU_Cache<int, int> lru(CAPACITY);
+    CacheSpace::LFU_Cache<int, int> lfu(CAPACITY);
+    CacheSpace::ARC_Cache<int, int> arc(CAPACITY);
+    CacheSpace::GDSF_Cache<int, int> gdsf(CAPACITY);
+
+    runCostWorkload("LRU", lru, plainPut, KEYS, OPERATIONS);
+    runCostWorkload("LFU", lfu, plainPut, KEYS, OPERATIONS);
+    runCostWorkload("ARC", arc, plainPut, KEYS, OPERATIONS);
+    runCostWorkload("GDSF", gdsf, costPut, KEYS, OPERATIONS);
+}
+
+template<typename Cache>
+void runSampledWorkload(const std::string& name, Cache& cache, uint64_t keys, int operations) {
+    CacheSpace::ScrambledZipfianKeys generator(keys, 0.99, SEED);
+    int hits = 0;
+    int value;
+
+    Timer timer;
+    for (int op = 0; op < operations; ++op) {
+        int key = static_cast<int>(generator.next());
+        if (cache.get(key, value)) hits++;
+        else cache.put(key, key);
+    }
+
+    std::cout << std::left << std::setw(11) << name << std::right
+              << " - Hit Rate: " << std::fixed << std::setprecision(2) << 100.0 * hits / operations
+              << "%, time: " << timer.elapsed() << " ms" << std::endl;
+}
+
+// 采样淘汰只在条目上保存一个 32 位字（24 位时钟或 8 位对数计数器），
+// 与链表实现的精确 LRU/LFU 比较命中率，并给出每个条目的元数据开销
+void testSampledEviction() {
+    std::cout << "\n=== Test Scenario 21: Sampled Approximate LRU/LFU Test ===" << std::endl;
+
+    const int CAPACITY = 20000;
+    const uint64_t KEYS = 400000;
+    const int OPERATIONS = 1000000;
+
+    CacheSpace::LRU_Cache<int, int> lru(CAPACITY);
+    CacheSpace::LFU_Cache<int, int> lfu(CAPACITY);
+    CacheSpace::Sampled_Cache<int, int> sampledLru(CAPACITY);
+    CacheSpace::SampledOptions lfuOptions;
+    lfuOptions.mode = CacheSpace::SampledMode::LFU;
+    CacheSpace::Sampled_Cache<int, int> sampledLfu(CAPACITY, lfuOptions);
+
+    runSampledWorkload("LRU", lru, KEYS, OPERATIONS);
+    runSampledWorkload("Sampled LRU", sampledLru, KEYS, OPERATIONS);
+    runSampledWorkload("LFU", lfu, KEYS, OPERATIONS);
+    runSampledWorkload("Sampled LFU", sampledLfu, KEYS, OPERATIONS);
+
+    std::cout << "sampled metadata: " << std::setprecision(1)
+              << static_cast<double>(sampledLru.metadataBytes()) / sampledLru.size() << " bytes per entry" << std::endl;
+}
+
 int main() {
     testHotDataAccess();
     testLoopPattern();
     testWorkloadShift();
+    testStackDistance();
+    testSnapshotRestart();
+    testTieredSpill();
+    testConcurrentHits();
+    testStaticDispatch();
+    testNearCache();
+    testHotKeyReplication();
+    testDeferredRelease();
+    testAdaptivePolicy();
+    testScanResistance();
+    testSequentialPrefetch();
+    testSharedMemory();
+    testNegativeLookups();
+    testCompressedTier();
+    testOnlineResize();
+    testMemoryPressure();
+    testCostAwareEviction();
+    testSampledEviction();
 
     return 0;
 };
\ No newline at end of file
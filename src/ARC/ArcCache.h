@@ -1,65 +1,348 @@
 #pragma once
 
-#include "ArcLRU.h"
-#include "ArcLFU.h"
+#include "../CacheHash.h"
 #include "../CachePolicy.h"
+#include "../Reclaim/RetireList.h"
+#include "../Snapshot/Snapshot.h"
 
-#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
 
 namespace CacheSpace {
+    // Adaptive Replacement Cache (Megiddo & Modha) over a single entry table.
+    // Every key the policy knows about has exactly one entry, tagged with the
+    // list it is on: T1 (seen recently), T2 (seen `threshold` times), or the
+    // ghost lists B1/B2 of keys evicted from them. Lists are intrusive, so a
+    // hit or a promotion is a relink, and a ghost entry keeps only its key
+    // fingerprint: the key and value are released when it leaves T1/T2.
+    //
+    // The target size of T1 (`_target`) grows on a B1 hit and shrinks on a B2
+    // hit. A get() of a ghost is an ordinary miss; the adaptation happens when
+    // the key is put back.
     template<typename Key, typename Value>
     class ARC_Cache : public CachePolicy<Key, Value> {
         public:
             explicit ARC_Cache(size_t capacity = 10, size_t threshold = 2):
                 _capacity(capacity),
-                _transformThreshold(threshold),
-                _LRU_Part(std::make_unique<ARC_LRU<Key, Value>>(capacity, threshold)),
-                _LFU_Part(std::make_unique<ARC_LFU<Key, Value>>(capacity, threshold)) {}
+                _transformThreshold(std::max<size_t>(threshold, 1)),
+                _target(0) {}
             ~ARC_Cache() override = default;
 
             Value get(Key key) override {
-                Value value;
+                Value value{};
                 get(key, value);
                 return value;
             }
 
             bool get(Key key, Value& value) override {
-                checkGhostCaches(key);
+                std::lock_guard<std::mutex> lock(_mutex);
 
-                bool shouldTransform = false;
-                if (_LRU_Part->get(key, value, shouldTransform)) {
-                    if (shouldTransform) _LFU_Part->put(key, value);
-                    return true;
-                }
-                return _LFU_Part->get(key, value);
+                Entry* entry = findResident(key);
+                if (!entry) return false;
+
+                recordAccess(*entry);
+                value = entry->value;
+                return true;
             }
 
             void put(Key key, Value value) override {
-                checkGhostCaches(key);
+                RetireScope<Value> retired;
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                trimLocked(RESIZE_STEP);
+                if (_capacity == 0) return;
+                uint64_t fp = fingerprint(key);
+                auto it = _entries.find(fp);
+                if (it != _entries.end()) {
+                    Entry& entry = it->second;
+                    if (isResident(entry) && entry.key == key) {
+                        EvictionBatch<Key, Value>::released(entry.value);
+                        entry.value = value;
+                        relink(entry, entry.list);
+                        return;
+                    }
+                    if (!isResident(entry)) {
+                        reviveGhost(entry, key, value);
+                        return;
+                    }
+                    // A different resident key with the same fingerprint.
+                    drop(entry);
+                }
+
+                makeRoomForNewKey();
+                Entry& entry = _entries[fp];
+                entry.fp = fp;
+                entry.key = key;
+                entry.value = value;
+                entry.accessCnt = 1;
+                pushFront(entry, T1);
+            }
+
+            // Forgets the key entirely, ghost history included. Returns
+            // whether the key was cached; a ghost alone does not count.
+            bool remove(Key key) {
+                RetireScope<Value> retired;
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                auto it = _entries.find(fingerprint(key));
+                if (it == _entries.end()) return false;
+                bool resident = isResident(it->second);
+                if (resident && !(it->second.key == key)) return false;
+                drop(it->second);
+                return resident;
+            }
+
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _lists[T1].size + _lists[T2].size;
+            }
+
+            // Growing takes effect at once. After a shrink, each put() moves up
+            // to RESIZE_STEP surplus entries from T1/T2 to the ghost lists and
+            // then trims the ghosts to the new bounds; trim() does the same
+            // without a put. The T1 target is clamped to the new capacity.
+            void setCapacity(size_t capacity) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _capacity = capacity;
+                _target = std::min(_target, _capacity);
+            }
+
+            // Returns how many resident entries are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                RetireScope<Value> retired;
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                size_t resident = _lists[T1].size + _lists[T2].size;
+                return resident > _capacity ? resident - _capacity : 0;
+            }
 
-                bool inLFU = _LFU_Part->contain(key);
-                _LRU_Part->put(key, value);
-                if (inLFU) _LFU_Part->put(key, value);
+            size_t capacity() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _capacity;
+            }
+
+            // Saves the T1 target and all four lists from least to most recent;
+            // ghosts are saved as fingerprints.
+            bool saveSnapshot(const std::string& path) {
+                SnapshotWriter writer(SnapshotPolicy::ARC);
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+
+                    writer.write(static_cast<uint64_t>(_target));
+                    for (ListTag tag : {T1, T2}) {
+                        writer.write(static_cast<uint64_t>(_lists[tag].size));
+                        for (Entry* entry = _lists[tag].tail; entry; entry = entry->prev) {
+                            writer.write(entry->key);
+                            writer.write(entry->value);
+                            writer.write(static_cast<uint64_t>(entry->accessCnt));
+                        }
+                    }
+                    for (ListTag tag : {B1, B2}) {
+                        writer.write(static_cast<uint64_t>(_lists[tag].size));
+                        for (Entry* entry = _lists[tag].tail; entry; entry = entry->prev) {
+                            writer.write(entry->fp);
+                        }
+                    }
+                }
+                return writer.commit(path);
+            }
+
+            // Rebuilds the lists in one pass; a snapshot from a larger cache is
+            // trimmed back to this capacity through the normal replacement.
+            bool loadSnapshot(const std::string& path) {
+                SnapshotReader reader;
+                uint64_t target;
+                if (!reader.open(path, SnapshotPolicy::ARC) || !reader.read(target)) return false;
+
+                RetireScope<Value> retired;
+                std::lock_guard<std::mutex> lock(_mutex);
+                clearInternal();
+                _target = std::min<size_t>(target, _capacity);
+
+                uint64_t count, accessCnt, fp;
+                Key key;
+                Value value;
+                for (ListTag tag : {T1, T2}) {
+                    if (!reader.read(count)) return false;
+                    for (uint64_t i = 0; i < count; i++) {
+                        if (!reader.read(key) || !reader.read(value) || !reader.read(accessCnt)) return false;
+
+                        fp = fingerprint(key);
+                        if (_entries.count(fp)) continue;
+                        Entry& entry = _entries[fp];
+                        entry.fp = fp;
+                        entry.key = key;
+                        entry.value = value;
+                        entry.accessCnt = accessCnt;
+                        pushFront(entry, tag);
+                    }
+                }
+                for (ListTag tag : {B1, B2}) {
+                    if (!reader.read(count)) return false;
+                    for (uint64_t i = 0; i < count; i++) {
+                        if (!reader.read(fp)) return false;
+
+                        if (_entries.count(fp)) continue;
+                        Entry& entry = _entries[fp];
+                        entry.fp = fp;
+                        entry.accessCnt = 0;
+                        pushFront(entry, tag);
+                    }
+                }
+
+                while (_lists[T1].size + _lists[T2].size > _capacity) replace(false);
+                while (_lists[T1].size + _lists[B1].size > _capacity && _lists[B1].size > 0) drop(*_lists[B1].tail);
+                while (_entries.size() > 2 * _capacity && _lists[B2].size > 0) drop(*_lists[B2].tail);
+                return reader.atEnd();
             }
         private:
+            enum ListTag : uint8_t { T1 = 0, T2 = 1, B1 = 2, B2 = 3 };
+
+            struct Entry {
+                Key key{};
+                Value value{};
+                uint64_t fp = 0;
+                size_t accessCnt = 0;
+                ListTag list = T1;
+                Entry* prev = nullptr;
+                Entry* next = nullptr;
+            };
+
+            // Most recent at the head.
+            struct List {
+                Entry* head = nullptr;
+                Entry* tail = nullptr;
+                size_t size = 0;
+            };
+
+            std::mutex _mutex;
             size_t _capacity;
             size_t _transformThreshold;
+            size_t _target;
+
+            // Keyed by fingerprint so ghosts need no key; entries never move
+            // once inserted, which keeps the intrusive links valid.
+            std::unordered_map<uint64_t, Entry> _entries;
+            List _lists[4];
+
+            static uint64_t fingerprint(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+
+            static bool isResident(const Entry& entry) {
+                return entry.list == T1 || entry.list == T2;
+            }
+
+            Entry* findResident(const Key& key) {
+                auto it = _entries.find(fingerprint(key));
+                if (it == _entries.end() || !isResident(it->second) || !(it->second.key == key)) return nullptr;
+                return &it->second;
+            }
+
+            void pushFront(Entry& entry, ListTag tag) {
+                List& list = _lists[tag];
+                entry.list = tag;
+                entry.prev = nullptr;
+                entry.next = list.head;
+                if (list.head) list.head->prev = &entry;
+                list.head = &entry;
+                if (!list.tail) list.tail = &entry;
+                list.size++;
+            }
+
+            void unlink(Entry& entry) {
+                List& list = _lists[entry.list];
+                if (entry.prev) entry.prev->next = entry.next;
+                else list.head = entry.next;
+                if (entry.next) entry.next->prev = entry.prev;
+                else list.tail = entry.prev;
+                list.size--;
+            }
+
+            void relink(Entry& entry, ListTag tag) {
+                unlink(entry);
+                pushFront(entry, tag);
+            }
 
-            std::unique_ptr<ARC_LRU<Key, Value>> _LRU_Part;
-            std::unique_ptr<ARC_LFU<Key, Value>> _LFU_Part;
+            void recordAccess(Entry& entry) {
+                entry.accessCnt++;
+                relink(entry, entry.list == T1 && entry.accessCnt >= _transformThreshold ? T2 : entry.list);
+            }
+
+            // Moves the LRU end of T1 or T2 to the matching ghost list.
+            void replace(bool hitInB2) {
+                List& t1 = _lists[T1];
+                bool fromT1 = t1.size > 0 &&
+                    (t1.size > _target || (hitInB2 && t1.size == _target) || _lists[T2].size == 0);
+
+                Entry& victim = *(fromT1 ? t1.tail : _lists[T2].tail);
+                unlink(victim);
+                EvictionBatch<Key, Value>::released(victim.value);
+                victim.key = Key();
+                victim.value = Value();
+                victim.accessCnt = 0;
+                pushFront(victim, fromT1 ? B1 : B2);
+            }
+
+            void drop(Entry& entry) {
+                unlink(entry);
+                if (isResident(entry)) EvictionBatch<Key, Value>::released(entry.value);
+                _entries.erase(entry.fp);
+            }
+
+            void reviveGhost(Entry& entry, const Key& key, const Value& value) {
+                size_t b1 = std::max<size_t>(_lists[B1].size, 1);
+                size_t b2 = std::max<size_t>(_lists[B2].size, 1);
+                bool inB2 = entry.list == B2;
+
+                if (!inB2) _target = std::min(_capacity, _target + std::max<size_t>(b2 / b1, 1));
+                else _target -= std::min(_target, std::max<size_t>(b1 / b2, 1));
 
-            bool checkGhostCaches(Key key) {
-                bool inGhost = false;
+                unlink(entry);
+                if (_lists[T1].size + _lists[T2].size >= _capacity) replace(inB2);
 
-                if (_LRU_Part->checkGhost(key)) {
-                    if (_LFU_Part->decreaseCapacity()) _LRU_Part->increaseCapacity();
-                    inGhost = true;
-                } else if (_LFU_Part->checkGhost(key)) {
-                    if (_LRU_Part->decreaseCapacity()) _LFU_Part->increaseCapacity();
-                    inGhost = true;
+                entry.key = key;
+                entry.value = value;
+                entry.accessCnt = _transformThreshold;
+                pushFront(entry, T2);
+            }
+
+            void makeRoomForNewKey() {
+                size_t resident = _lists[T1].size + _lists[T2].size;
+                size_t t1Side = _lists[T1].size + _lists[B1].size;
+
+                if (t1Side >= _capacity) {
+                    if (_lists[B1].size > 0) {
+                        drop(*_lists[B1].tail);
+                        if (resident >= _capacity) replace(false);
+                    } else {
+                        drop(*_lists[T1].tail);
+                    }
+                } else if (_entries.size() >= _capacity) {
+                    if (_entries.size() >= 2 * _capacity && _lists[B2].size > 0) drop(*_lists[B2].tail);
+                    if (resident >= _capacity) replace(false);
                 }
+            }
+
+            // One step per resident entry demoted or ghost dropped, in the
+            // order the bounds are restored: c resident entries, c entries on
+            // the T1 side, 2c entries in all.
+            void trimLocked(size_t maxEntries) {
+                for (; maxEntries > 0; maxEntries--) {
+                    if (_lists[T1].size + _lists[T2].size > _capacity) replace(false);
+                    else if (_lists[T1].size + _lists[B1].size > _capacity && _lists[B1].size > 0) drop(*_lists[B1].tail);
+                    else if (_entries.size() > 2 * _capacity && _lists[B2].size > 0) drop(*_lists[B2].tail);
+                    else return;
+                }
+            }
 
-                return inGhost;
+            void clearInternal() {
+                _entries.clear();
+                for (List& list : _lists) list = List();
+                _target = 0;
             }
     };
 }
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+#include "../LRU/LRUCache.h"
+#include "../LFU/LFUCache.h"
+#include "../ARC/ArcCache.h"
+#include "../LIRS/LIRSCache.h"
+#include "../S3FIFO/S3FIFOCache.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <shared_mutex>
+
+namespace CacheSpace {
+    enum class PolicyKind { LRU, LRU_K, LFU, ARC, LIRS, S3FIFO };
+
+    // One candidate configuration. `param` is the policy's tuning knob:
+    // k for LRU-K, maxAverageNum for LFU, the transform threshold for ARC,
+    // the HIR ratio for LIRS and the small-queue ratio for S3-FIFO.
+    struct PolicyChoice {
+        PolicyKind kind;
+        double param;
+
+        std::string name() const {
+            switch (kind) {
+                case PolicyKind::LRU: return "LRU";
+                case PolicyKind::LRU_K: return "LRU-K(k=" + std::to_string(static_cast<int>(param)) + ")";
+                case PolicyKind::LFU: return "LFU(maxAvg=" + std::to_string(static_cast<int>(param)) + ")";
+                case PolicyKind::ARC: return "ARC(threshold=" + std::to_string(static_cast<int>(param)) + ")";
+                case PolicyKind::LIRS: return "LIRS";
+                case PolicyKind::S3FIFO: return "S3-FIFO";
+            }
+            return "?";
+        }
+    };
+
+    template<typename Key, typename Value>
+    std::unique_ptr<CachePolicy<Key, Value>> makePolicy(const PolicyChoice& choice, size_t capacity) {
+        int size = static_cast<int>(capacity);
+        switch (choice.kind) {
+            case PolicyKind::LRU:
+                return std::make_unique<LRU_Cache<Key, Value>>(size);
+            case PolicyKind::LRU_K:
+                return std::make_unique<LRU_K_Cache<Key, Value>>(size, size * 2, static_cast<int>(choice.param));
+            case PolicyKind::LFU:
+                return std::make_unique<LFU_Cache<Key, Value>>(size, static_cast<int>(choice.param));
+            case PolicyKind::ARC:
+                return std::make_unique<ARC_Cache<Key, Value>>(capacity, static_cast<size_t>(choice.param));
+            case PolicyKind::LIRS:
+                return std::make_unique<LIRS_Cache<Key, Value>>(size, choice.param);
+            case PolicyKind::S3FIFO:
+                return std::make_unique<S3FIFO_Cache<Key, Value>>(size, choice.param);
+        }
+        return nullptr;
+    }
+
+    struct AdaptiveOptions {
+        uint32_t sampleDivisor = 16;        // shadow 1 key in N, by key hash
+        uint32_t decisionInterval = 4096;   // sampled gets between decisions
+        double switchMargin = 0.02;         // required hit-ratio advantage
+    };
+
+    // Runs the live cache with one policy while scaled-down shadow copies of
+    // every candidate replay a hash-sampled subset of the traffic (SHARDS-style
+    // spatial sampling: the shadows see 1/N of the keys and have 1/N of the
+    // capacity, so their hit ratios track full-size ones). After every
+    // decision interval the best shadow is compared with the live policy's
+    // shadow, and the live cache is rebuilt with the winner if it leads by
+    // `switchMargin`.
+    //
+    // A switch starts the new cache empty; until it has served `capacity`
+    // misses, misses fall back to the old cache and copy hits across, and puts
+    // go to both. While that migration runs, the copy and put() of one key are
+    // serialized by a striped mutex, and no further switch is made. Shadows
+    // hold no values and cost one pass over the candidates per sampled access.
+    template<typename Key, typename Value>
+    class Adaptive_Cache : public CachePolicy<Key, Value> {
+        public:
+            static std::vector<PolicyChoice> defaultChoices() {
+                return {
+                    {PolicyKind::LRU, 0},
+                    {PolicyKind::LRU_K, 2},
+                    {PolicyKind::LFU, 1000000},
+                    {PolicyKind::LFU, 10},
+                    {PolicyKind::ARC, 2},
+                    {PolicyKind::ARC, 4},
+                    {PolicyKind::LIRS, 0.01},
+                    {PolicyKind::S3FIFO, 0.1},
+                };
+            }
+
+            Adaptive_Cache(size_t capacity,
+                           std::vector<PolicyChoice> choices = defaultChoices(),
+                           const AdaptiveOptions& options = AdaptiveOptions()):
+                _capacity(capacity),
+                _options(options),
+                _choices(std::move(choices)),
+                _current(0),
+                _sampledGets(0),
+                _switches(0),
+                _migrationLeft(0) {
+                    if (_choices.empty()) _choices.push_back({PolicyKind::LRU, 0});
+                    if (_options.sampleDivisor == 0) _options.sampleDivisor = 1;
+
+                    size_t shadowCapacity = std::max<size_t>(capacity / _options.sampleDivisor, 4);
+                    for (const auto& choice : _choices) {
+                        _shadows.push_back(Shadow{makePolicy<Key, uint8_t>(choice, shadowCapacity), 0, 0});
+                    }
+                    _live = makePolicy<Key, Value>(_choices[0], capacity);
+                }
+            ~Adaptive_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                bool hit = getLive(key, value);
+                if (sampled(key)) recordGet(key);
+                return hit;
+            }
+
+            void put(Key key, Value value) override {
+                {
+                    std::shared_lock<std::shared_mutex> lock(_liveMutex);
+                    if (_previous) {
+                        std::lock_guard<std::mutex> migrating(stripe(key));
+                        _live->put(key, value);
+                        _previous->put(key, value);
+                    } else {
+                        _live->put(key, value);
+                    }
+                }
+                if (sampled(key)) recordPut(key);
+            }
+
+            std::string currentPolicy() {
+                std::lock_guard<std::mutex> lock(_shadowMutex);
+                return _choices[_current].name();
+            }
+
+            size_t switches() const { return _switches.load(std::memory_order_relaxed); }
+
+            // Hit ratio of each candidate's shadow over the current window.
+            std::vector<std::pair<std::string, double>> shadowHitRatios() {
+                std::lock_guard<std::mutex> lock(_shadowMutex);
+                std::vector<std::pair<std::string, double>> result;
+                for (size_t i = 0; i < _shadows.size(); i++) {
+                    result.emplace_back(_choices[i].name(), _shadows[i].ratio());
+                }
+                return result;
+            }
+        private:
+            static constexpr size_t STRIPES = 64;
+
+            using cache_ptr = std::unique_ptr<CachePolicy<Key, Value>>;
+
+            struct Shadow {
+                std::unique_ptr<CachePolicy<Key, uint8_t>> cache;
+                uint64_t gets;
+                uint64_t hits;
+
+                double ratio() const { return gets ? static_cast<double>(hits) / gets : 0.0; }
+            };
+
+            size_t _capacity;
+            AdaptiveOptions _options;
+            std::vector<PolicyChoice> _choices;
+
+            // Guards the live/previous pointers; the caches lock themselves.
+            std::shared_mutex _liveMutex;
+            cache_ptr _live;
+            cache_ptr _previous;
+            std::array<std::mutex, STRIPES> _stripes;   // taken under _liveMutex during a migration
+
+            // Taken without _liveMutex held, and before it when both are needed.
+            std::mutex _shadowMutex;
+            std::vector<Shadow> _shadows;
+            size_t _current;
+            uint32_t _sampledGets;
+
+            std::atomic<size_t> _switches;
+            std::atomic<int64_t> _migrationLeft;
+
+            bool sampled(const Key& key) const {
+                return CacheHash<Key>()(key) % _options.sampleDivisor == 0;
+            }
+
+            std::mutex& stripe(const Key& key) {
+                return _stripes[CacheHash<Key>()(key) % STRIPES];
+            }
+
+            // The copy re-checks the live cache under the key's stripe, so a
+            // value a concurrent put() has already replaced is never copied.
+            bool getLive(const Key& key, Value& value) {
+                std::shared_lock<std::shared_mutex> lock(_liveMutex);
+                if (_live->get(key, value)) return true;
+                if (!_previous) return false;
+
+                _migrationLeft.fetch_sub(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> migrating(stripe(key));
+                if (_live->get(key, value)) return true;
+                if (!_previous->get(key, value)) return false;
+                _live->put(key, value);
+                return true;
+            }
+
+            // A retired cache is declared before the lock guard, so it is
+            // destroyed only after _shadowMutex has been released.
+            void recordGet(const Key& key) {
+                cache_ptr retired;
+                std::lock_guard<std::mutex> lock(_shadowMutex);
+
+                uint8_t dummy;
+                for (auto& shadow : _shadows) {
+                    shadow.gets++;
+                    if (shadow.cache->get(key, dummy)) shadow.hits++;
+                }
+
+                if (++_sampledGets >= _options.decisionInterval) {
+                    _sampledGets = 0;
+                    retired = decide();
+                }
+            }
+
+            void recordPut(const Key& key) {
+                std::lock_guard<std::mutex> lock(_shadowMutex);
+                for (auto& shadow : _shadows) shadow.cache->put(key, 0);
+            }
+
+            // Caller holds _shadowMutex. Returns the old cache once its
+            // migration is over, for the caller to destroy outside the locks.
+            cache_ptr decide() {
+                size_t best = _current;
+                for (size_t i = 0; i < _shadows.size(); i++) {
+                    if (_shadows[i].ratio() > _shadows[best].ratio()) best = i;
+                }
+
+                bool switching = best != _current &&
+                    _shadows[best].ratio() >= _shadows[_current].ratio() + _options.switchMargin;
+
+                cache_ptr retired;
+                {
+                    std::unique_lock<std::shared_mutex> lock(_liveMutex);
+                    if (_previous && _migrationLeft.load(std::memory_order_relaxed) <= 0) retired = std::move(_previous);
+
+                    if (switching && !_previous) {
+                        _previous = std::move(_live);
+                        _live = makePolicy<Key, Value>(_choices[best], _capacity);
+                        _migrationLeft.store(static_cast<int64_t>(_capacity), std::memory_order_relaxed);
+                        _current = best;
+                        _switches.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+
+                // Halve the window so older traffic fades instead of vanishing.
+                for (auto& shadow : _shadows) {
+                    shadow.gets /= 2;
+                    shadow.hits /= 2;
+                }
+                return retired;
+            }
+    };
+}
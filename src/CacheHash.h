@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace CacheSpace {
+    // 64-bit finalizer from MurmurHash3: a few multiplies and shifts that spread
+    // every input bit over the whole word.
+    inline uint64_t mixHash(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Hash used for shard selection, fingerprints and flat tables. Integral
+    // keys skip std::hash (the identity on libstdc++) and go straight through
+    // the mixer, so consecutive keys still spread over shards and buckets.
+    template<typename Key, typename Enable = void>
+    struct CacheHash {
+        size_t operator()(const Key& key) const {
+            return mixHash(std::hash<Key>()(key));
+        }
+    };
+
+    template<typename Key>
+    struct CacheHash<Key, typename std::enable_if<std::is_integral<Key>::value>::type> {
+        size_t operator()(Key key) const {
+            return mixHash(static_cast<uint64_t>(key));
+        }
+    };
+
+    // Keys and values that can live inline in flat slots and be copied with
+    // plain loads and stores.
+    template<typename Key, typename Value>
+    struct is_flat_cacheable : std::integral_constant<bool,
+        std::is_integral<Key>::value && std::is_trivially_copyable<Value>::value> {};
+}
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cstddef>
+
 namespace CacheSpace {
+    // Most entries one operation evicts while a cache works off the surplus
+    // left by shrinking it with setCapacity().
+    constexpr size_t RESIZE_STEP = 8;
+
     template<typename Key, typename Value>
     class CachePolicy {
         public:
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "LZCodec.h"
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace CacheSpace {
+    struct CompressedOptions {
+        size_t coldBytes = 64 << 20;    // budget for compressed entries
+        size_t minValueBytes = 64;      // smaller values are stored as is
+        size_t dictionaryBytes = 16 << 10;  // sample size for the shared dictionary; 0 disables
+        bool background = true;         // compress on a worker thread, else in compressPending()
+    };
+
+    // In-memory store for cold string values, compressed with LZ and kept in
+    // LRU order under a byte budget. add() runs under the memory tier's lock,
+    // so it only parks the value uncompressed; the worker thread (or, without
+    // `background`, the owner through compressPending()) compresses it later,
+    // outside every lock. A take() in the meantime is served from the parked
+    // copy. Parked values count against the budget at their raw size, so a
+    // worker that falls behind costs cold entries, not unbounded memory.
+    // Values that do not shrink are kept uncompressed.
+    //
+    // Cache values are usually too small to compress well on their own, so
+    // the first `dictionaryBytes` of cold values are kept as an LZ dictionary
+    // for everything compressed after them.
+    template<typename Key>
+    class ColdStore {
+        public:
+            // Bookkeeping per entry (map node, LRU node, key) counted against
+            // the budget on top of the stored bytes.
+            static constexpr size_t ENTRY_OVERHEAD = 64;
+
+            explicit ColdStore(const CompressedOptions& options):
+                _options(options),
+                _bytes(0),
+                _rawBytes(0),
+                _sequence(0),
+                _stop(false) {
+                    if (_options.background) _worker = std::thread([this]() { compressLoop(); });
+                }
+
+            ~ColdStore() {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stop = true;
+                }
+                _queueReady.notify_all();
+                if (_worker.joinable()) _worker.join();
+            }
+
+            ColdStore(const ColdStore&) = delete;
+            ColdStore& operator=(const ColdStore&) = delete;
+
+            void add(const Key& key, const std::string& value) {
+                size_t charge = value.size() + ENTRY_OVERHEAD;
+                if (charge > _options.coldBytes) return;
+
+                auto parked = std::make_shared<const std::string>(value);
+                std::lock_guard<std::mutex> lock(_mutex);
+                eraseLocked(key);
+                if (!makeRoomLocked(charge)) return;
+                _bytes += charge;
+                _rawBytes += value.size();
+                _pending[key] = Pending{std::move(parked), ++_sequence};
+                _queue.emplace_back(key, _sequence);
+                if (_options.background) _queueReady.notify_one();
+            }
+
+            // Compresses everything parked so far on the calling thread. Only
+            // needed without `background`; call it with no cache lock held.
+            void compressPending() {
+                if (_options.background) return;
+                std::vector<std::pair<Key, Pending>> batch;
+                std::vector<Entry> encoded;
+                while (true) {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (_queue.empty()) return;
+                        takeBatchLocked(batch);
+                    }
+                    compressBatch(batch, encoded);
+                }
+            }
+
+            // Removes the entry and returns its value.
+            bool take(const Key& key, std::string& value) {
+                Entry entry;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto parked = _pending.find(key);
+                    if (parked != _pending.end()) {
+                        value = *parked->second.value;
+                        erasePendingLocked(parked);
+                        return true;
+                    }
+
+                    auto it = _entries.find(key);
+                    if (it == _entries.end()) return false;
+                    entry = detachLocked(it);
+                }
+
+                if (!entry.compressed) {
+                    value = std::move(entry.blob);
+                    return true;
+                }
+                return LZ::decompress(entry.blob.data(), entry.blob.size(), value, entry.dictionary.get());
+            }
+
+            void remove(const Key& key) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                eraseLocked(key);
+            }
+
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _entries.size() + _pending.size();
+            }
+
+            // Bytes held by stored and parked entries, overhead included.
+            size_t bytes() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _bytes;
+            }
+
+            // What the same entries would take uncompressed.
+            size_t rawBytes() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _rawBytes;
+            }
+        private:
+            static constexpr size_t BATCH = 64;
+
+            struct Entry {
+                std::string blob;
+                size_t rawSize = 0;
+                bool compressed = false;
+                std::shared_ptr<const LZ::Dictionary> dictionary;
+                typename std::list<Key>::iterator position;
+
+                size_t charge() const { return blob.size() + ENTRY_OVERHEAD; }
+            };
+
+            // A value waiting for the worker; `sequence` tells a re-added key
+            // apart from the copy the worker is compressing.
+            struct Pending {
+                std::shared_ptr<const std::string> value;
+                uint64_t sequence;
+            };
+
+            CompressedOptions _options;
+
+            std::mutex _mutex;
+            std::unordered_map<Key, Entry> _entries;
+            std::list<Key> _recency;    // most recent at the front
+            size_t _bytes;
+            size_t _rawBytes;
+
+            std::unordered_map<Key, Pending> _pending;
+            std::deque<std::pair<Key, uint64_t>> _queue;
+            uint64_t _sequence;
+            std::condition_variable _queueReady;
+            bool _stop;
+            std::thread _worker;
+
+            std::mutex _sampleMutex;
+            std::string _samples;
+            std::shared_ptr<const LZ::Dictionary> _dictionary;
+
+            void encode(const std::string& value, Entry& entry) {
+                entry.rawSize = value.size();
+                entry.compressed = false;
+                entry.dictionary = dictionary(value);
+                if (value.size() >= _options.minValueBytes) {
+                    LZ::compress(value.data(), value.size(), entry.blob, entry.dictionary.get());
+                    entry.compressed = entry.blob.size() < value.size();
+                }
+                if (!entry.compressed) {
+                    entry.blob = value;
+                    entry.dictionary.reset();
+                }
+                entry.blob.shrink_to_fit();
+            }
+
+            // Returns the dictionary once trained; until then collects samples.
+            std::shared_ptr<const LZ::Dictionary> dictionary(const std::string& value) {
+                auto current = std::atomic_load(&_dictionary);
+                if (current || _options.dictionaryBytes == 0) return current;
+
+                std::lock_guard<std::mutex> lock(_sampleMutex);
+                current = std::atomic_load(&_dictionary);
+                if (current) return current;
+                _samples.append(value, 0, _options.dictionaryBytes - _samples.size());
+                if (_samples.size() < _options.dictionaryBytes) return nullptr;
+
+                current = std::make_shared<const LZ::Dictionary>(std::move(_samples));
+                std::atomic_store(&_dictionary, current);
+                return current;
+            }
+
+            // Evicts the least recent stored entries, then the oldest parked
+            // ones, until `charge` more bytes fit; false if they cannot.
+            bool makeRoomLocked(size_t charge) {
+                while (_bytes + charge > _options.coldBytes) {
+                    if (!_recency.empty()) {
+                        unlinkLocked(_entries.find(_recency.back()));
+                        continue;
+                    }
+                    if (_queue.empty()) return false;
+                    auto item = _queue.front();
+                    _queue.pop_front();
+                    auto it = _pending.find(item.first);
+                    if (it != _pending.end() && it->second.sequence == item.second) erasePendingLocked(it);
+                }
+                return true;
+            }
+
+            void insertLocked(const Key& key, Entry&& entry) {
+                if (!makeRoomLocked(entry.charge())) return;
+
+                _recency.push_front(key);
+                entry.position = _recency.begin();
+                _bytes += entry.charge();
+                _rawBytes += entry.rawSize;
+                _entries[key] = std::move(entry);
+            }
+
+            Entry detachLocked(typename std::unordered_map<Key, Entry>::iterator it) {
+                _bytes -= it->second.charge();
+                _rawBytes -= it->second.rawSize;
+                _recency.erase(it->second.position);
+                Entry entry = std::move(it->second);
+                _entries.erase(it);
+                return entry;
+            }
+
+            void unlinkLocked(typename std::unordered_map<Key, Entry>::iterator it) {
+                detachLocked(it);
+            }
+
+            void erasePendingLocked(typename std::unordered_map<Key, Pending>::iterator it) {
+                _bytes -= it->second.value->size() + ENTRY_OVERHEAD;
+                _rawBytes -= it->second.value->size();
+                _pending.erase(it);
+            }
+
+            void eraseLocked(const Key& key) {
+                auto parked = _pending.find(key);
+                if (parked != _pending.end()) erasePendingLocked(parked);
+                auto it = _entries.find(key);
+                if (it != _entries.end()) unlinkLocked(it);
+            }
+
+            void compressLoop() {
+                std::vector<std::pair<Key, Pending>> batch;
+                std::vector<Entry> encoded;
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _queueReady.wait(lock, [this]() { return _stop || !_queue.empty(); });
+                        if (_stop) return;
+                        takeBatchLocked(batch);
+                    }
+                    compressBatch(batch, encoded);
+                }
+            }
+
+            void takeBatchLocked(std::vector<std::pair<Key, Pending>>& batch) {
+                batch.clear();
+                while (!_queue.empty() && batch.size() < BATCH) {
+                    auto item = _queue.front();
+                    _queue.pop_front();
+                    auto it = _pending.find(item.first);
+                    if (it != _pending.end() && it->second.sequence == item.second) {
+                        batch.emplace_back(item.first, it->second);
+                    }
+                }
+            }
+
+            // Installs only the values that are still parked under the same
+            // sequence; the others were taken, removed or re-added meanwhile.
+            void compressBatch(std::vector<std::pair<Key, Pending>>& batch, std::vector<Entry>& encoded) {
+                encoded.resize(batch.size());
+                for (size_t i = 0; i < batch.size(); i++) encode(*batch[i].second.value, encoded[i]);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (size_t i = 0; i < batch.size(); i++) {
+                    auto it = _pending.find(batch[i].first);
+                    if (it == _pending.end() || it->second.sequence != batch[i].second.sequence) continue;
+                    erasePendingLocked(it);
+                    insertLocked(batch[i].first, std::move(encoded[i]));
+                }
+            }
+    };
+}
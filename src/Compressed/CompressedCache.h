@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ColdStore.h"
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+#include "../LRU/LRUCache.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace CacheSpace {
+    // String cache with a compressed cold tier: entries the memory policy
+    // evicts (the LRU tail of LRU_Cache, the lowest-frequency entries of
+    // LFU_Cache, or the sharded variants) are compressed into a ColdStore
+    // instead of being dropped. A cold hit is decompressed and put back into
+    // the memory policy; it is compressed again only when evicted again.
+    //
+    // A promotion and a put() of the same key are serialized by a striped
+    // mutex, so a promotion can never overwrite a newer value. Lock order is
+    // stripe -> memory tier -> cold tier (the eviction listener runs inside
+    // the memory tier's lock, so it only parks the value; compression happens
+    // on the cold tier's worker, or after the locks are released).
+    template<typename Key, typename MemoryCache = LRU_Cache<Key, std::string>>
+    class Compressed_Cache : public CachePolicy<Key, std::string> {
+        public:
+            template<typename... Args>
+            explicit Compressed_Cache(const CompressedOptions& options, Args&&... memoryArgs):
+                _memory(std::make_unique<MemoryCache>(std::forward<Args>(memoryArgs)...)),
+                _cold(std::make_unique<ColdStore<Key>>(options)),
+                _memoryHits(0),
+                _coldHits(0) {
+                    ColdStore<Key>* cold = _cold.get();
+                    _memory->setEvictionListener([cold](const Key& key, const std::string& value) {
+                        cold->add(key, value);
+                    });
+                }
+            ~Compressed_Cache() override {
+                _memory->setEvictionListener(nullptr);
+            }
+
+            std::string get(Key key) override {
+                std::string value;
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, std::string& value) override {
+                if (_memory->get(key, value)) {
+                    _memoryHits++;
+                    return true;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(stripe(key));
+                    if (_memory->get(key, value)) {
+                        _memoryHits++;
+                        return true;
+                    }
+                    if (!_cold->take(key, value)) return false;
+                    _coldHits++;
+                    _memory->put(key, value);
+                }
+                _cold->compressPending();
+                return true;
+            }
+
+            void put(Key key, std::string value) override {
+                {
+                    std::lock_guard<std::mutex> lock(stripe(key));
+                    _cold->remove(key);
+                    _memory->put(key, std::move(value));
+                }
+                _cold->compressPending();
+            }
+
+            void remove(Key key) {
+                std::lock_guard<std::mutex> lock(stripe(key));
+                _memory->remove(key);
+                _cold->remove(key);
+            }
+
+            size_t memoryHits() const { return _memoryHits.load(std::memory_order_relaxed); }
+
+            size_t coldHits() const { return _coldHits.load(std::memory_order_relaxed); }
+
+            size_t coldEntries() { return _cold->size(); }
+
+            size_t coldBytes() { return _cold->bytes(); }
+
+            size_t coldRawBytes() { return _cold->rawBytes(); }
+        private:
+            static constexpr size_t STRIPES = 64;
+
+            std::unique_ptr<MemoryCache> _memory;
+            std::unique_ptr<ColdStore<Key>> _cold;
+            std::array<std::mutex, STRIPES> _stripes;
+
+            std::atomic<size_t> _memoryHits;
+            std::atomic<size_t> _coldHits;
+
+            std::mutex& stripe(const Key& key) {
+                return _stripes[CacheHash<Key>()(key) % STRIPES];
+            }
+    };
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace CacheSpace {
+    // Byte-oriented LZ77 codec in the LZ4 style: a single pass with a small
+    // hash table of 4-byte sequences, no entropy coding. It trades ratio for
+    // speed, which is what a cache wants on its eviction path.
+    //
+    // Stream: varint raw length, then sequences of
+    //   token (literal length << 4 | match length - 4), [length bytes],
+    //   literals, 16-bit little-endian offset, [match length bytes]
+    // where a nibble of 15 continues in 255-valued bytes. The last sequence
+    // has literals only.
+    //
+    // Small values (a few hundred bytes) have little to match against, so a
+    // Dictionary of typical content can be passed to both sides: it acts as
+    // bytes preceding the input, and matches may reach back into it.
+    namespace LZ {
+        constexpr size_t MIN_MATCH = 4;
+        constexpr size_t MAX_OFFSET = 65535;
+        constexpr int HASH_BITS = 12;
+
+        inline uint32_t read32(const char* p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint32_t hashOf(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // Preset content for small values, with its hash table built once.
+        struct Dictionary {
+            std::string data;
+            uint32_t table[1 << HASH_BITS];
+
+            explicit Dictionary(std::string content): data(std::move(content)) {
+                if (data.size() > MAX_OFFSET) data.erase(0, data.size() - MAX_OFFSET);
+                std::memset(table, 0xff, sizeof(table));
+                for (size_t pos = 0; pos + MIN_MATCH <= data.size(); pos++) {
+                    table[hashOf(read32(data.data() + pos))] = static_cast<uint32_t>(pos);
+                }
+            }
+        };
+
+        inline void writeLength(std::string& out, size_t length) {
+            while (length >= 255) {
+                out.push_back(static_cast<char>(255));
+                length -= 255;
+            }
+            out.push_back(static_cast<char>(length));
+        }
+
+        inline void writeSequence(std::string& out, const char* literals, size_t literalLength,
+                                  size_t offset, size_t matchLength) {
+            size_t matchCode = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+            uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) |
+                                                 (matchLength ? std::min<size_t>(matchCode, 15) : 0));
+            out.push_back(static_cast<char>(token));
+            if (literalLength >= 15) writeLength(out, literalLength - 15);
+            if (literalLength) out.append(literals, literalLength);
+            if (!matchLength) return;
+
+            out.push_back(static_cast<char>(offset & 0xff));
+            out.push_back(static_cast<char>(offset >> 8));
+            if (matchCode >= 15) writeLength(out, matchCode - 15);
+        }
+
+        inline void compress(const char* src, size_t size, std::string& out, const Dictionary* dictionary = nullptr) {
+            out.clear();
+            out.reserve(size / 2 + 16);
+            for (size_t v = size; ; v >>= 7) {
+                out.push_back(static_cast<char>((v & 0x7f) | (v >= 0x80 ? 0x80 : 0)));
+                if (v < 0x80) break;
+            }
+
+            // With a dictionary the matcher runs over dictionary + input.
+            static thread_local std::string joined;
+            size_t start = 0;
+            uint32_t table[1 << HASH_BITS];
+            if (dictionary && size > 0) {
+                start = dictionary->data.size();
+                joined.assign(dictionary->data).append(src, size);
+                src = joined.data();
+                size += start;
+                std::memcpy(table, dictionary->table, sizeof(table));
+            } else {
+                std::memset(table, 0xff, sizeof(table));
+            }
+
+            size_t anchor = start;
+            size_t pos = start;
+            // Leave a literal tail so matching never reads past the end.
+            size_t matchLimit = size - start > 12 ? size - 5 : 0;
+            while (pos + MIN_MATCH <= matchLimit) {
+                uint32_t sequence = read32(src + pos);
+                uint32_t& slot = table[hashOf(sequence)];
+                size_t candidate = slot;
+                slot = static_cast<uint32_t>(pos);
+
+                if (candidate == UINT32_MAX || pos - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                    pos++;
+                    continue;
+                }
+
+                size_t length = MIN_MATCH;
+                while (pos + length < matchLimit && src[candidate + length] == src[pos + length]) length++;
+
+                writeSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+                if (pos >= 2 && pos + MIN_MATCH <= matchLimit) table[hashOf(read32(src + pos - 2))] = static_cast<uint32_t>(pos - 2);
+            }
+            writeSequence(out, src + anchor, size - anchor, 0, 0);
+        }
+
+        // Returns false on a corrupt or truncated stream. `dictionary` must be
+        // the one the value was compressed with.
+        inline bool decompress(const char* src, size_t size, std::string& out, const Dictionary* dictionary = nullptr) {
+            const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+            const uint8_t* end = in + size;
+
+            uint64_t rawSize = 0;
+            for (int shift = 0; ; shift += 7) {
+                if (in == end || shift > 56) return false;
+                uint8_t byte = *in++;
+                rawSize |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+
+            // Each input byte expands to at most 255 output bytes.
+            if (rawSize > static_cast<uint64_t>(end - in) * 255 + 16) return false;
+            out.resize(rawSize);
+            char* dst = out.empty() ? nullptr : &out[0];
+            size_t written = 0;
+
+            auto readLength = [&](size_t& length) {
+                uint8_t byte;
+                do {
+                    if (in == end) return false;
+                    byte = *in++;
+                    length += byte;
+                } while (byte == 255);
+                return true;
+            };
+
+            while (in < end) {
+                uint8_t token = *in++;
+                size_t literalLength = token >> 4;
+                if (literalLength == 15 && !readLength(literalLength)) return false;
+                if (static_cast<size_t>(end - in) < literalLength || rawSize - written < literalLength) return false;
+                if (literalLength) std::memcpy(dst + written, in, literalLength);
+                in += literalLength;
+                written += literalLength;
+                if (in == end) break;
+
+                if (end - in < 2) return false;
+                size_t offset = in[0] | (size_t(in[1]) << 8);
+                in += 2;
+                size_t matchLength = token & 15;
+                if (matchLength == 15 && !readLength(matchLength)) return false;
+                matchLength += MIN_MATCH;
+
+                size_t dictionarySize = dictionary ? dictionary->data.size() : 0;
+                if (offset == 0 || offset > written + dictionarySize || rawSize - written < matchLength) return false;
+                // Byte by byte: the match may overlap the bytes it produces,
+                // and may start in the dictionary and run into the output.
+                for (size_t i = 0; i < matchLength; i++) {
+                    size_t back = written + i;
+                    dst[back] = offset <= back ? dst[back - offset] : dictionary->data[dictionarySize - (offset - back)];
+                }
+                written += matchLength;
+            }
+            return written == rawSize;
+        }
+    }
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // GreedyDual-Size-Frequency (Cherkasova, 1998). Each entry has a miss
+    // cost and a size, and priority
+    //     H = L + frequency * cost / size
+    // where L, the inflation clock, is the priority of the last evicted
+    // entry. The entry with the lowest H is evicted, so cheap-to-reload,
+    // large and rarely used entries go first, and raising L ages entries
+    // that stopped being hit. What it maximizes is the reload cost saved,
+    // not the hit count.
+    //
+    // Capacity is in the same units as the sizes (bytes, or entries when
+    // every size is 1). Priorities live in an indexed binary min-heap, so a
+    // hit, insert or eviction is O(log n). put() without a cost and size
+    // uses 1 for both, which makes the policy LFU with aging.
+    template<typename Key, typename Value>
+    class GDSF_Cache : public CachePolicy<Key, Value> {
+        public:
+            explicit GDSF_Cache(size_t capacity):
+                _capacity(capacity),
+                _used(0),
+                _clock(0),
+                _savedCost(0) {}
+            ~GDSF_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return false;
+
+                Entry& entry = it->second;
+                entry.frequency++;
+                reprioritize(entry);
+                _savedCost += entry.cost;
+                value = entry.value;
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                put(key, value, 1.0, 1);
+            }
+
+            // An entry bigger than the whole capacity is not cached. A put of
+            // a cached key replaces its value, cost and size and counts as a
+            // reference.
+            void put(Key key, Value value, double cost, size_t size) {
+                size = std::max<size_t>(size, 1);
+                cost = std::max(cost, 0.0);
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                trimLocked(RESIZE_STEP);
+                auto it = _entries.find(key);
+                if (size > _capacity) {
+                    if (it != _entries.end()) eraseLocked(it);
+                    return;
+                }
+
+                if (it != _entries.end()) {
+                    Entry& entry = it->second;
+                    _used = _used - entry.size + size;
+                    entry.value = value;
+                    entry.cost = cost;
+                    entry.size = size;
+                    entry.frequency++;
+                    reprioritize(entry);
+                    // A grown entry may itself be the lowest priority left.
+                    makeRoom(0, &entry);
+                    return;
+                }
+
+                makeRoom(size, nullptr);
+                Entry& entry = _entries.emplace(key, Entry(key, value, cost, size)).first->second;
+                entry.priority = _clock + cost / size;
+                _used += size;
+                heapPush(&entry);
+            }
+
+            void remove(Key key) {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                auto it = _entries.find(key);
+                if (it != _entries.end()) eraseLocked(it);
+            }
+
+            // Shrinks drain over later puts, as in the other policies.
+            void setCapacity(size_t capacity) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _capacity = capacity;
+            }
+
+            // Returns how many size units are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                return _used > _capacity ? _used - _capacity : 0;
+            }
+
+            size_t capacity() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _capacity;
+            }
+
+            // Entries cached.
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _entries.size();
+            }
+
+            // Sum of the sizes of the cached entries.
+            size_t used() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _used;
+            }
+
+            // Sum of the costs of the entries get() has returned.
+            double savedCost() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _savedCost;
+            }
+        private:
+            struct Entry {
+                Key key;
+                Value value;
+                double cost;
+                size_t size;
+                uint64_t frequency;
+                double priority;
+                size_t heapIndex;
+
+                Entry(const Key& k, const Value& v, double c, size_t s):
+                    key(k), value(v), cost(c), size(s), frequency(1), priority(0), heapIndex(0) {}
+            };
+
+            std::mutex _mutex;
+            size_t _capacity;
+            size_t _used;
+            double _clock;
+            double _savedCost;
+
+            // Node-based, so entries never move and the heap can point at them.
+            std::unordered_map<Key, Entry> _entries;
+            std::vector<Entry*> _heap;
+
+            void reprioritize(Entry& entry) {
+                entry.priority = _clock + entry.frequency * entry.cost / entry.size;
+                siftDown(entry.heapIndex);
+                siftUp(entry.heapIndex);
+            }
+
+            // Evicts lowest-priority entries until `incoming` more fits,
+            // never `keep` (the entry being updated).
+            void makeRoom(size_t incoming, Entry* keep) {
+                while (!_heap.empty() && _used + incoming > _capacity) {
+                    if (_heap[0] == keep && _heap.size() == 1) return;
+                    evictLowest(keep);
+                }
+            }
+
+            void trimLocked(size_t maxEntries) {
+                for (; maxEntries > 0 && _used > _capacity && !_heap.empty(); maxEntries--) evictLowest(nullptr);
+            }
+
+            void evictLowest(Entry* keep) {
+                size_t index = 0;
+                // The kept entry is the minimum: take the smaller child instead.
+                if (_heap[0] == keep) {
+                    index = _heap.size() > 2 && _heap[2]->priority < _heap[1]->priority ? 2 : 1;
+                }
+                Entry* victim = _heap[index];
+                _clock = std::max(_clock, victim->priority);
+                eraseLocked(_entries.find(victim->key));
+            }
+
+            void eraseLocked(typename std::unordered_map<Key, Entry>::iterator it) {
+                Entry* entry = &it->second;
+                heapRemove(entry->heapIndex);
+                _used -= entry->size;
+                _entries.erase(it);
+            }
+
+            void heapPush(Entry* entry) {
+                entry->heapIndex = _heap.size();
+                _heap.push_back(entry);
+                siftUp(entry->heapIndex);
+            }
+
+            void heapRemove(size_t index) {
+                Entry* last = _heap.back();
+                _heap.pop_back();
+                if (index == _heap.size()) return;
+
+                _heap[index] = last;
+                last->heapIndex = index;
+                siftDown(index);
+                siftUp(last->heapIndex);
+            }
+
+            void place(Entry* entry, size_t index) {
+                _heap[index] = entry;
+                entry->heapIndex = index;
+            }
+
+            void siftUp(size_t index) {
+                Entry* entry = _heap[index];
+                while (index > 0) {
+                    size_t parent = (index - 1) / 2;
+                    if (_heap[parent]->priority <= entry->priority) break;
+                    place(_heap[parent], index);
+                    index = parent;
+                }
+                place(entry, index);
+            }
+
+            void siftDown(size_t index) {
+                Entry* entry = _heap[index];
+                size_t count = _heap.size();
+                while (true) {
+                    size_t child = 2 * index + 1;
+                    if (child >= count) break;
+                    if (child + 1 < count && _heap[child + 1]->priority < _heap[child]->priority) child++;
+                    if (entry->priority <= _heap[child]->priority) break;
+                    place(_heap[child], index);
+                    index = child;
+                }
+                place(entry, index);
+            }
+    };
+
+    template<typename Key, typename Value>
+    class Hash_GDSF_Cache : public CachePolicy<Key, Value> {
+        public:
+            Hash_GDSF_Cache(size_t capacity, int sliceNum):
+                _sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) {
+                    size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+
+                    for (size_t i = 0; i < _sliceNum; i++) {
+                        _slicedCache.emplace_back(new GDSF_Cache<Key, Value>(size));
+                    }
+                }
+
+            Value get(Key key) {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) {
+                return _slicedCache[Hash(key) % _sliceNum]->get(key, value);
+            }
+
+            void put(Key key, Value value) {
+                _slicedCache[Hash(key) % _sliceNum]->put(key, value);
+            }
+
+            void put(Key key, Value value, double cost, size_t size) {
+                _slicedCache[Hash(key) % _sliceNum]->put(key, value, cost, size);
+            }
+
+            void remove(Key key) {
+                _slicedCache[Hash(key) % _sliceNum]->remove(key);
+            }
+
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+
+            double savedCost() {
+                double total = 0;
+                for (auto& cache : _slicedCache) total += cache->savedCost();
+                return total;
+            }
+        private:
+            size_t _sliceNum;
+            std::vector<std::unique_ptr<GDSF_Cache<Key, Value>>> _slicedCache;
+
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+    };
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "SpaceSaving.h"
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace CacheSpace {
+    struct HotKeyOptions {
+        size_t trackedKeys = 64;        // Space-Saving counters
+        size_t maxHotKeys = 16;         // keys replicated at once
+        size_t replicas = 0;            // 0: one per hardware thread
+        uint32_t sampleEvery = 16;      // feed one access in N per thread
+        uint32_t refreshEvery = 1024;   // samples between hot-set updates
+        double hotShare = 0.02;         // min share of samples to be hot
+    };
+
+    // Read replication for heavy hitters in front of a sharded cache. Accesses
+    // are sampled into a Space-Saving sketch; keys above `hotShare` of the
+    // recent samples are copied into every replica slot, each with its own
+    // lock and cache line. A thread reads hot keys from its own replica, so a
+    // single dominant key is spread over `replicas` locks instead of one shard
+    // lock. A put to a hot key rewrites all replicas; a remove drops the
+    // copies until the next put.
+    //
+    // Membership is checked first against a small bit filter, so cold keys
+    // pay one atomic load before going to the backing cache.
+    template<typename Key, typename Value, typename Backing>
+    class HotKey_Cache : public CachePolicy<Key, Value> {
+        public:
+            HotKey_Cache(Backing& backing, const HotKeyOptions& options = HotKeyOptions()):
+                _backing(backing),
+                _options(options),
+                _sketch(options.trackedKeys),
+                _samples(0),
+                _filterCounts(FILTER_BITS, 0),
+                _replicaCursor(0) {
+                    size_t replicas = options.replicas > 0 ? options.replicas : std::thread::hardware_concurrency();
+                    if (replicas == 0) replicas = 1;
+                    for (size_t i = 0; i < replicas; i++) _replicas.emplace_back(new Replica());
+                    for (auto& word : _filter) word.store(0, std::memory_order_relaxed);
+                }
+            ~HotKey_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                size_t hash = CacheHash<Key>()(key);
+                sample(key);
+
+                if (mayBeHot(hash)) {
+                    Replica& replica = localReplica();
+                    std::lock_guard<std::mutex> lock(replica.mutex);
+                    auto it = replica.entries.find(key);
+                    if (it != replica.entries.end()) {
+                        value = it->second;
+                        return true;
+                    }
+                }
+                return _backing.get(key, value);
+            }
+
+            // The backing write comes first and the filter is checked after it;
+            // a concurrent promotion sets the filter before reading the backing
+            // cache, so one of the two always sees the other's value.
+            void put(Key key, Value value) override {
+                _backing.put(key, value);
+
+                if (!mayBeHot(CacheHash<Key>()(key))) return;
+                std::lock_guard<std::mutex> lock(_hotMutex);
+                if (_hotKeys.count(key) == 0) return;
+                for (auto& replica : _replicas) {
+                    std::lock_guard<std::mutex> replicaLock(replica->mutex);
+                    replica->entries[key] = value;
+                }
+            }
+
+            // Same ordering as put: a promotion racing with the remove either
+            // reads the backing cache after it, or is undone here.
+            void remove(Key key) {
+                _backing.remove(key);
+
+                if (!mayBeHot(CacheHash<Key>()(key))) return;
+                std::lock_guard<std::mutex> lock(_hotMutex);
+                if (_hotKeys.count(key) == 0) return;
+                for (auto& replica : _replicas) {
+                    std::lock_guard<std::mutex> replicaLock(replica->mutex);
+                    replica->entries.erase(key);
+                }
+            }
+
+            // Current replicated keys, for monitoring.
+            std::vector<Key> hotKeys() {
+                std::lock_guard<std::mutex> lock(_hotMutex);
+                return std::vector<Key>(_hotKeys.begin(), _hotKeys.end());
+            }
+
+            // Heaviest tracked keys with their estimated sample counts.
+            std::vector<typename SpaceSaving<Key>::Counter> topKeys(size_t n) {
+                std::lock_guard<std::mutex> lock(_sketchMutex);
+                return _sketch.top(n);
+            }
+
+            size_t replicaCount() const { return _replicas.size(); }
+        private:
+            static constexpr size_t FILTER_BITS = 4096;
+
+            struct alignas(64) Replica {
+                std::mutex mutex;
+                std::unordered_map<Key, Value> entries;
+            };
+
+            Backing& _backing;
+            HotKeyOptions _options;
+
+            std::mutex _sketchMutex;
+            SpaceSaving<Key> _sketch;
+            uint32_t _samples;
+
+            // _hotMutex guards the hot set, the filter counts and replica
+            // membership; it is taken after _sketchMutex when both are needed.
+            std::mutex _hotMutex;
+            std::unordered_set<Key> _hotKeys;
+            std::vector<uint8_t> _filterCounts;
+            std::atomic<uint64_t> _filter[FILTER_BITS / 64];
+
+            std::vector<std::unique_ptr<Replica>> _replicas;
+            std::atomic<size_t> _replicaCursor;
+
+            bool mayBeHot(size_t hash) const {
+                size_t bit = hash % FILTER_BITS;
+                return (_filter[bit / 64].load(std::memory_order_seq_cst) >> (bit % 64)) & 1;
+            }
+
+            Replica& localReplica() {
+                thread_local size_t slot = SIZE_MAX;
+                if (slot == SIZE_MAX) slot = _replicaCursor.fetch_add(1, std::memory_order_relaxed);
+                return *_replicas[slot % _replicas.size()];
+            }
+
+            void sample(const Key& key) {
+                thread_local uint32_t counter = 0;
+                if (++counter < _options.sampleEvery) return;
+                counter = 0;
+
+                std::lock_guard<std::mutex> lock(_sketchMutex);
+                _sketch.offer(key);
+                if (++_samples < _options.refreshEvery) return;
+                _samples = 0;
+                refreshHotSet();
+                _sketch.decay();
+            }
+
+            void refreshHotSet() {
+                uint64_t threshold = static_cast<uint64_t>(_options.hotShare * _sketch.total());
+                std::unordered_set<Key> wanted;
+                for (const auto& counter : _sketch.top(_options.maxHotKeys)) {
+                    // The guaranteed part of the count must clear the bar.
+                    if (counter.count - counter.error >= threshold && threshold > 0) wanted.insert(counter.key);
+                }
+
+                std::lock_guard<std::mutex> lock(_hotMutex);
+                std::vector<Key> leaving;
+                for (const auto& key : _hotKeys) {
+                    if (wanted.count(key) == 0) leaving.push_back(key);
+                }
+                for (const auto& key : leaving) demote(key);
+                for (const auto& key : wanted) {
+                    if (_hotKeys.count(key) == 0) promote(key);
+                }
+            }
+
+            // Caller holds _hotMutex.
+            void promote(const Key& key) {
+                size_t bit = CacheHash<Key>()(key) % FILTER_BITS;
+                if (_filterCounts[bit]++ == 0) {
+                    _filter[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_seq_cst);
+                }
+                _hotKeys.insert(key);
+
+                Value value;
+                if (!_backing.get(key, value)) return;
+                for (auto& replica : _replicas) {
+                    std::lock_guard<std::mutex> replicaLock(replica->mutex);
+                    replica->entries[key] = value;
+                }
+            }
+
+            // Caller holds _hotMutex.
+            void demote(const Key& key) {
+                for (auto& replica : _replicas) {
+                    std::lock_guard<std::mutex> replicaLock(replica->mutex);
+                    replica->entries.erase(key);
+                }
+                _hotKeys.erase(key);
+
+                size_t bit = CacheHash<Key>()(key) % FILTER_BITS;
+                if (--_filterCounts[bit] == 0) {
+                    _filter[bit / 64].fetch_and(~(uint64_t(1) << (bit % 64)), std::memory_order_seq_cst);
+                }
+            }
+    };
+}
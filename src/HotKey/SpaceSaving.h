@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // Space-Saving heavy-hitter sketch (Metwally et al.): tracks at most
+    // `capacity` keys. An untracked key replaces the one with the smallest
+    // count and inherits that count as its error bound, so every key whose
+    // true frequency exceeds total / capacity is guaranteed to be tracked.
+    // Counters live in a min-heap, making each offer O(log capacity).
+    //
+    // Not synchronized: callers hold their own lock.
+    template<typename Key>
+    class SpaceSaving {
+        public:
+            struct Counter {
+                Key key;
+                uint64_t count;
+                uint64_t error;
+            };
+
+            explicit SpaceSaving(size_t capacity): _capacity(capacity > 0 ? capacity : 1), _total(0) {
+                _heap.reserve(_capacity);
+            }
+
+            void offer(const Key& key, uint64_t weight = 1) {
+                _total += weight;
+
+                auto it = _position.find(key);
+                if (it != _position.end()) {
+                    _heap[it->second].count += weight;
+                    siftDown(it->second);
+                    return;
+                }
+
+                if (_heap.size() < _capacity) {
+                    _heap.push_back(Counter{key, weight, 0});
+                    _position[key] = _heap.size() - 1;
+                    siftUp(_heap.size() - 1);
+                    return;
+                }
+
+                Counter& root = _heap.front();
+                _position.erase(root.key);
+                root = Counter{key, root.count + weight, root.count};
+                _position[key] = 0;
+                siftDown(0);
+            }
+
+            // Tracked keys by descending count.
+            std::vector<Counter> top(size_t n) const {
+                std::vector<Counter> result(_heap);
+                std::sort(result.begin(), result.end(),
+                    [](const Counter& a, const Counter& b) { return a.count > b.count; });
+                if (result.size() > n) result.resize(n);
+                return result;
+            }
+
+            // Halves every count so old traffic fades; halving is monotone and
+            // keeps the heap ordered.
+            void decay() {
+                for (auto& counter : _heap) {
+                    counter.count /= 2;
+                    counter.error /= 2;
+                }
+                _total /= 2;
+            }
+
+            uint64_t total() const { return _total; }
+
+            size_t size() const { return _heap.size(); }
+        private:
+            size_t _capacity;
+            uint64_t _total;
+            std::vector<Counter> _heap;
+            std::unordered_map<Key, size_t> _position;
+
+            void swapAt(size_t a, size_t b) {
+                std::swap(_heap[a], _heap[b]);
+                _position[_heap[a].key] = a;
+                _position[_heap[b].key] = b;
+            }
+
+            void siftUp(size_t i) {
+                while (i > 0) {
+                    size_t parent = (i - 1) / 2;
+                    if (_heap[parent].count <= _heap[i].count) break;
+                    swapAt(parent, i);
+                    i = parent;
+                }
+            }
+
+            void siftDown(size_t i) {
+                while (true) {
+                    size_t smallest = i;
+                    size_t left = 2 * i + 1, right = left + 1;
+                    if (left < _heap.size() && _heap[left].count < _heap[smallest].count) smallest = left;
+                    if (right < _heap.size() && _heap[right].count < _heap[smallest].count) smallest = right;
+                    if (smallest == i) break;
+                    swapAt(i, smallest);
+                    i = smallest;
+                }
+            }
+    };
+}
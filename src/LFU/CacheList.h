@@ -32,6 +32,12 @@ namespace CacheSpace {
                 _tail->prev = _head;
             }
 
+            // Unlinks iteratively so a long list is not destroyed recursively.
+            ~FreqList() {
+                node_ptr node = std::move(_head);
+                while (node) node = std::move(node->next);
+            }
+
             bool isEmpty() const {
                 return _head->next == _tail;
             }
@@ -1,10 +1,19 @@
 #pragma once
 
 #include "CacheList.h"
+#include "../CacheHash.h"
 #include "../CachePolicy.h"
+#include "../Reclaim/RetireList.h"
+#include "../Snapshot/Snapshot.h"
 
+#include <cmath>
 #include <mutex>
+#include <climits>
+#include <string>
 #include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
 #include <unordered_map>
 
 
@@ -15,6 +24,8 @@ namespace CacheSpace {
             using Node = typename FreqList<Key, Value>::Node;
             using node_ptr = std::shared_ptr<Node>;
             using node_map = std::unordered_map<Key, node_ptr>;
+            using eviction_listener = std::function<void(const Key&, const Value&)>;
+            using batch_eviction_listener = typename EvictionBatch<Key, Value>::listener_type;
 
             LFU_Cache(int capacity, int maxAverageNum = 1000000): 
                 _minFreq(INT_MAX),
@@ -22,7 +33,9 @@ namespace CacheSpace {
                 _maxAvgNum(maxAverageNum),
                 _curAvgNum(0),
                 _curTotalNum(0) {}
-            ~LFU_Cache() override = default;
+            ~LFU_Cache() override {
+                clearInternal();
+            }
 
             Value get(Key key) override {
                 Value value;
@@ -41,10 +54,13 @@ namespace CacheSpace {
             }
 
             void put(Key key, Value value) override {
-                if (_capacity == 0) return;
+                typename EvictionBatch<Key, Value>::Scope retired(_evictionBatch);
                 std::lock_guard<std::mutex> lock(_mutex);
 
+                trimLocked(RESIZE_STEP);
+                if (_capacity <= 0) return;
                 if (_nodeRecords.count(key)) {
+                    EvictionBatch<Key, Value>::released(_nodeRecords[key]->value);
                     _nodeRecords[key]->value = value;
                     getInternal(_nodeRecords[key], value);
                     return;
@@ -53,10 +69,123 @@ namespace CacheSpace {
                 putInternal(key, value);
             }
 
+            // The entry is destroyed after the lock is released. Returns
+            // whether the key was cached.
+            bool remove(Key key) {
+                node_ptr released;
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end()) return false;
+                released = it->second;
+                removeFromFreqList(released);
+                _nodeRecords.erase(it);
+                decreaseFreqNum(released->freq);
+                if (released->freq == _minFreq && _freqLists[_minFreq]->isEmpty()) updateMinFreq();
+                return true;
+            }
+
+            // Shrinks drain like LRU_Cache's: up to RESIZE_STEP surplus
+            // entries per put(), lowest frequency first, or through trim().
+            void setCapacity(size_t capacity) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _capacity = static_cast<int>(capacity);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                typename EvictionBatch<Key, Value>::Scope retired(_evictionBatch);
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                return surplusLocked();
+            }
+
+            size_t capacity() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return static_cast<size_t>(std::max(_capacity, 0));
+            }
+
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _nodeRecords.size();
+            }
+
+            // The entries are destroyed after the lock is released.
             void purge() {
+                node_map released;
                 std::lock_guard<std::mutex> lock(_mutex);
-                _nodeRecords.clear();
-                _freqLists.clear();
+                released.swap(_nodeRecords);
+                clearInternal();
+            }
+
+            // Called with every entry dropped for capacity (not for remove()),
+            // under the cache lock.
+            void setEvictionListener(eviction_listener listener) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _evictionListener = std::move(listener);
+            }
+
+            // Called once per put() that evicted, with the evicted entries,
+            // after the cache lock has been released.
+            void setBatchEvictionListener(batch_eviction_listener listener) {
+                _evictionBatch.setListener(std::move(listener));
+            }
+
+            // Entries are stored by ascending frequency, and in eviction order
+            // within each frequency, so a reload evicts in the same order.
+            bool saveSnapshot(const std::string& path) {
+                SnapshotWriter writer(SnapshotPolicy::LFU);
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+
+                    std::vector<int> freqs;
+                    freqs.reserve(_freqLists.size());
+                    for (const auto& pair : _freqLists) freqs.push_back(pair.first);
+                    std::sort(freqs.begin(), freqs.end());
+
+                    writer.write(static_cast<uint64_t>(_nodeRecords.size()));
+                    for (int freq : freqs) {
+                        FreqList<Key, Value>* list = _freqLists[freq];
+                        for (node_ptr node = list->_head->next; node != list->_tail; node = node->next) {
+                            writer.write(node->key);
+                            writer.write(node->value);
+                            writer.write(static_cast<int32_t>(node->freq));
+                        }
+                    }
+                }
+                return writer.commit(path);
+            }
+
+            // Rebuilds the frequency lists in one bulk pass. If the snapshot holds
+            // more than `_capacity` entries, the least frequent ones are dropped.
+            bool loadSnapshot(const std::string& path) {
+                SnapshotReader reader;
+                uint64_t count;
+                if (!reader.open(path, SnapshotPolicy::LFU) || !reader.read(count)) return false;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                clearInternal();
+
+                uint64_t skip = count > static_cast<uint64_t>(std::max(_capacity, 0)) ? count - _capacity : 0;
+                _nodeRecords.reserve(count - skip);
+
+                Key key;
+                Value value;
+                int32_t freq;
+                for (uint64_t i = 0; i < count; i++) {
+                    if (!reader.read(key) || !reader.read(value) || !reader.read(freq)) return false;
+                    if (i < skip) continue;
+
+                    node_ptr node = std::make_shared<Node>(key, value);
+                    node->freq = std::max(1, static_cast<int>(freq));
+                    _nodeRecords[key] = node;
+                    addIntoFreqList(node);
+
+                    _curTotalNum += node->freq;
+                    _minFreq = std::min(_minFreq, node->freq);
+                }
+
+                _curAvgNum = _nodeRecords.empty() ? 0 : _curTotalNum / _nodeRecords.size();
+                return reader.atEnd();
             }
         private:
             int _minFreq;
@@ -67,6 +196,8 @@ namespace CacheSpace {
 
             std::mutex _mutex; 
             node_map _nodeRecords;
+            eviction_listener _evictionListener;
+            EvictionBatch<Key, Value> _evictionBatch;
             std::unordered_map<int, FreqList<Key, Value>*> _freqLists;
 
 
@@ -82,7 +213,7 @@ namespace CacheSpace {
             }
 
             void putInternal(Key key, Value value) {
-                if (_nodeRecords.size() == _capacity) cleanData();
+                if (_nodeRecords.size() >= static_cast<size_t>(_capacity)) cleanData();
 
                 node_ptr node = std::make_shared<Node>(key, value);
                 _nodeRecords[key] = node;
@@ -93,9 +224,36 @@ namespace CacheSpace {
 
             void cleanData() {
                 node_ptr node = _freqLists[_minFreq]->getFirstNode();
-                _curTotalNum -= node->freq;
+                removeFromFreqList(node);
                 _nodeRecords.erase(node->key);
                 decreaseFreqNum(node->freq);
+                if (_evictionListener) _evictionListener(node->key, node->value);
+                _evictionBatch.evicted(node->key, node->value);
+            }
+
+            size_t surplusLocked() const {
+                size_t capacity = static_cast<size_t>(std::max(_capacity, 0));
+                return _nodeRecords.size() > capacity ? _nodeRecords.size() - capacity : 0;
+            }
+
+            // cleanData() leaves `_minFreq` stale when it empties the lowest
+            // list, which put() covers by inserting at frequency 1; back-to-back
+            // evictions have to look the next one up.
+            void trimLocked(size_t maxEntries) {
+                for (size_t surplus = surplusLocked(); surplus > 0 && maxEntries > 0; surplus--, maxEntries--) {
+                    cleanData();
+                    if (_freqLists[_minFreq]->isEmpty()) updateMinFreq();
+                }
+            }
+
+            void clearInternal() {
+                for (auto& pair : _freqLists) delete pair.second;
+                _nodeRecords.clear();
+                _freqLists.clear();
+
+                _minFreq = INT_MAX;
+                _curAvgNum = 0;
+                _curTotalNum = 0;
             }
 
             void removeFromFreqList(node_ptr node) {
@@ -173,7 +331,7 @@ namespace CacheSpace {
                     size_t size = std::ceil(_capacity / static_cast<double>(_sliceNum));
 
                     for (size_t i = 0; i < _sliceNum; i++) {
-                        _slicedCache.push_back(new LFU_Cache<Key, Value>(size, maxAvgNum));
+                        _slicedCache.emplace_back(new LFU_Cache<Key, Value>(size, maxAvgNum));
                     }
                 }
 
@@ -193,17 +351,52 @@ namespace CacheSpace {
                 _slicedCache[index]->put(key, value);
             }
 
+            bool remove(Key key) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->remove(key);
+            }
+
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+
             void purge() {
                 for (auto& cache : _slicedCache) cache->purge();
             }
+
+            void setEvictionListener(typename LFU_Cache<Key, Value>::eviction_listener listener) {
+                for (auto& cache : _slicedCache) cache->setEvictionListener(listener);
+            }
+
+            void setBatchEvictionListener(typename LFU_Cache<Key, Value>::batch_eviction_listener listener) {
+                for (auto& cache : _slicedCache) cache->setBatchEvictionListener(listener);
+            }
         private:
             int _sliceNum;
             size_t _capacity;
             std::vector<std::unique_ptr<LFU_Cache<Key, Value>>> _slicedCache;
 
-            size_t Hash(Key key) {
-                std::hash<Key> hashFunc;
-                return hashFunc(key);
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
             }
     };
 }
@@ -0,0 +1,409 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // LIRS (Jiang & Zhang, SIGMETRICS'02). Entries are LIR (protected), resident
+    // HIR (holding a value, evicted first) or non-resident HIR (key-only
+    // history). Stack S orders entries by recency down to the oldest LIR entry;
+    // queue Q holds resident HIR entries in eviction order. Non-resident
+    // entries are bounded by a FIFO that reuses the Q links, since they are
+    // never in Q themselves.
+    template<typename Key, typename Value>
+    class LIRS_Cache : public CachePolicy<Key, Value> {
+        public:
+            LIRS_Cache(int capacity, double hirRatio = 0.01, int nonResidentCapacity = -1):
+                _hirRatio(hirRatio),
+                _nonResidentSetting(nonResidentCapacity),
+                _lirCount(0),
+                _hirCount(0) {
+                    applyCapacity(capacity);
+                }
+            ~LIRS_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_capacity <= 0) return false;
+
+                // A miss is not recorded here: the caller's follow-up put() is
+                // the same reference and will consult the non-resident history.
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end() || it->second.status == Status::NonResident) return false;
+
+                Node* node = &it->second;
+                accessResident(node);
+                value = node->value;
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                trimLocked(RESIZE_STEP);
+                if (_capacity <= 0) return;
+                auto it = _nodeRecords.find(key);
+                if (it != _nodeRecords.end() && it->second.status != Status::NonResident) {
+                    it->second.value = value;
+                    accessResident(&it->second);
+                    return;
+                }
+
+                if (_lirCount < _lirCapacity && it == _nodeRecords.end()) {
+                    Node* node = createNode(key);
+                    node->value = value;
+                    node->status = Status::LIR;
+                    node->inStack = true;
+                    _stack.pushTop(node, &Node::sPrev, &Node::sNext);
+                    _lirCount++;
+                    return;
+                }
+
+                if (_hirCount >= _hirCapacity) evictResidentHIR();
+
+                // The eviction above may have dropped the key's own history.
+                it = _nodeRecords.find(key);
+                if (it != _nodeRecords.end() && it->second.inStack) {
+                    Node* node = &it->second;
+                    _ghosts.remove(node, &Node::qPrev, &Node::qNext);
+                    node->value = value;
+                    node->status = Status::LIR;
+                    _lirCount++;
+                    _stack.moveToTop(node, &Node::sPrev, &Node::sNext);
+                    rebalanceLIR();
+                    return;
+                }
+
+                Node* node = it != _nodeRecords.end() ? &it->second : createNode(key);
+                if (it != _nodeRecords.end()) _ghosts.remove(node, &Node::qPrev, &Node::qNext);
+                node->value = value;
+                makeResidentHIR(node);
+                _stack.pushTop(node, &Node::sPrev, &Node::sNext);
+            }
+
+            void remove(Key key) {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end()) return;
+
+                Node* node = &it->second;
+                if (node->status == Status::LIR) _lirCount--;
+                if (node->status == Status::ResidentHIR) _hirCount--;
+                detachNode(node);
+                _nodeRecords.erase(it);
+                if (_lirCount > 0) pruneStack();
+            }
+
+            // The LIR and HIR shares and the default history bound follow the
+            // new capacity. After a shrink each put() takes up to RESIZE_STEP
+            // steps of demoting surplus LIR entries, evicting surplus resident
+            // HIR entries and dropping surplus history; trim() does the same
+            // without a put.
+            void setCapacity(size_t capacity) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                applyCapacity(static_cast<int>(capacity));
+            }
+
+            // Returns how many resident entries are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                int resident = _lirCount + _hirCount;
+                return resident > _capacity ? resident - _capacity : 0;
+            }
+
+            size_t capacity() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _capacity;
+            }
+
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _lirCount + _hirCount;
+            }
+        private:
+            enum class Status : unsigned char { LIR, ResidentHIR, NonResident };
+
+            struct Node {
+                Key key;
+                Value value;
+                Status status;
+                bool inStack;
+                Node* sPrev;
+                Node* sNext;
+                Node* qPrev;
+                Node* qNext;
+
+                explicit Node(const Key& k):
+                    key(k), value(), status(Status::NonResident), inStack(false),
+                    sPrev(nullptr), sNext(nullptr), qPrev(nullptr), qNext(nullptr) {}
+            };
+
+            // Intrusive list over one pair of Node link fields; `head` is the
+            // top of S / the front (oldest) of a FIFO, `tail` the other end.
+            struct List {
+                Node* head = nullptr;
+                Node* tail = nullptr;
+
+                bool empty() const { return head == nullptr; }
+
+                void pushTop(Node* node, Node* Node::*prev, Node* Node::*next) {
+                    node->*prev = nullptr;
+                    node->*next = head;
+                    if (head) head->*prev = node;
+                    head = node;
+                    if (!tail) tail = node;
+                }
+
+                void pushBack(Node* node, Node* Node::*prev, Node* Node::*next) {
+                    node->*next = nullptr;
+                    node->*prev = tail;
+                    if (tail) tail->*next = node;
+                    tail = node;
+                    if (!head) head = node;
+                }
+
+                void remove(Node* node, Node* Node::*prev, Node* Node::*next) {
+                    if (node->*prev) (node->*prev)->*next = node->*next;
+                    else if (head == node) head = node->*next;
+                    else return;
+
+                    if (node->*next) (node->*next)->*prev = node->*prev;
+                    else tail = node->*prev;
+                    node->*prev = nullptr;
+                    node->*next = nullptr;
+                }
+
+                void moveToTop(Node* node, Node* Node::*prev, Node* Node::*next) {
+                    if (head == node) return;
+                    remove(node, prev, next);
+                    pushTop(node, prev, next);
+                }
+            };
+
+            double _hirRatio;
+            int _nonResidentSetting;
+            int _capacity;
+            int _hirCapacity;
+            int _lirCapacity;
+            int _nonResidentCapacity;
+            int _lirCount;
+            int _hirCount;
+
+            std::mutex _mutex;
+            std::unordered_map<Key, Node> _nodeRecords;
+
+            List _stack;
+            List _queue;
+            List _ghosts;
+
+            void applyCapacity(int capacity) {
+                _capacity = std::max(capacity, 0);
+                _hirCapacity = _capacity > 0 ? std::max(1, static_cast<int>(_capacity * _hirRatio)) : 0;
+                _lirCapacity = std::max(0, _capacity - _hirCapacity);
+                _nonResidentCapacity = _nonResidentSetting >= 0 ? _nonResidentSetting : _capacity;
+            }
+
+            size_t ghostCount() const {
+                return _nodeRecords.size() - _lirCount - _hirCount;
+            }
+
+            // Surplus LIR entries are demoted first, so they can be evicted
+            // from Q in the following steps.
+            void trimLocked(size_t maxEntries) {
+                for (; maxEntries > 0; maxEntries--) {
+                    if (_lirCount > _lirCapacity) demoteBottomLIR();
+                    else if (_hirCount > _hirCapacity) evictResidentHIR();
+                    else if (ghostCount() > static_cast<size_t>(_nonResidentCapacity) && _ghosts.head) dropOldestGhost();
+                    else return;
+                }
+            }
+
+            Node* createNode(const Key& key) {
+                return &_nodeRecords.emplace(key, Node(key)).first->second;
+            }
+
+            void accessResident(Node* node) {
+                if (node->status == Status::LIR) {
+                    bool wasBottom = _stack.tail == node;
+                    _stack.moveToTop(node, &Node::sPrev, &Node::sNext);
+                    if (wasBottom) pruneStack();
+                    return;
+                }
+
+                if (node->inStack) {
+                    _stack.moveToTop(node, &Node::sPrev, &Node::sNext);
+                    _queue.remove(node, &Node::qPrev, &Node::qNext);
+                    _hirCount--;
+                    node->status = Status::LIR;
+                    _lirCount++;
+                    rebalanceLIR();
+                } else {
+                    node->inStack = true;
+                    _stack.pushTop(node, &Node::sPrev, &Node::sNext);
+                    _queue.remove(node, &Node::qPrev, &Node::qNext);
+                    _queue.pushBack(node, &Node::qPrev, &Node::qNext);
+                }
+            }
+
+            void makeResidentHIR(Node* node) {
+                node->status = Status::ResidentHIR;
+                node->inStack = true;
+                _queue.pushBack(node, &Node::qPrev, &Node::qNext);
+                _hirCount++;
+            }
+
+            // A promotion puts the LIR set one over its share, and one
+            // demotion restores it; a larger surplus left by setCapacity() is
+            // worked off by trimLocked() instead of in one pass here.
+            void rebalanceLIR() {
+                if (_lirCount > _lirCapacity) demoteBottomLIR();
+                pruneStack();
+            }
+
+            void demoteBottomLIR() {
+                pruneStack();
+                Node* bottom = _stack.tail;
+                if (!bottom) return;
+
+                _stack.remove(bottom, &Node::sPrev, &Node::sNext);
+                bottom->inStack = false;
+                bottom->status = Status::ResidentHIR;
+                _lirCount--;
+                _hirCount++;
+                _queue.pushBack(bottom, &Node::qPrev, &Node::qNext);
+            }
+
+            // Removes HIR entries from the bottom of S until it ends in an LIR
+            // entry; non-resident entries have no other reference and are freed.
+            void pruneStack() {
+                while (_stack.tail && _stack.tail->status != Status::LIR) {
+                    Node* bottom = _stack.tail;
+                    _stack.remove(bottom, &Node::sPrev, &Node::sNext);
+                    bottom->inStack = false;
+
+                    if (bottom->status == Status::NonResident) {
+                        _ghosts.remove(bottom, &Node::qPrev, &Node::qNext);
+                        _nodeRecords.erase(bottom->key);
+                    }
+                }
+            }
+
+            void evictResidentHIR() {
+                Node* victim = _queue.head;
+                if (!victim) return;
+
+                _queue.remove(victim, &Node::qPrev, &Node::qNext);
+                _hirCount--;
+
+                if (!victim->inStack) {
+                    _nodeRecords.erase(victim->key);
+                    return;
+                }
+
+                victim->status = Status::NonResident;
+                victim->value = Value();
+                addGhost(victim);
+            }
+
+            // Each new ghost puts the history at most one over its bound.
+            void addGhost(Node* node) {
+                _ghosts.pushBack(node, &Node::qPrev, &Node::qNext);
+                if (ghostCount() > static_cast<size_t>(_nonResidentCapacity)) dropOldestGhost();
+            }
+
+            void dropOldestGhost() {
+                Node* oldest = _ghosts.head;
+                _ghosts.remove(oldest, &Node::qPrev, &Node::qNext);
+                _stack.remove(oldest, &Node::sPrev, &Node::sNext);
+                _nodeRecords.erase(oldest->key);
+            }
+
+            void detachNode(Node* node) {
+                if (node->inStack) _stack.remove(node, &Node::sPrev, &Node::sNext);
+                if (node->status == Status::NonResident) _ghosts.remove(node, &Node::qPrev, &Node::qNext);
+                else _queue.remove(node, &Node::qPrev, &Node::qNext);
+            }
+    };
+
+    template<typename Key, typename Value>
+    class Hash_LIRS_Cache : public CachePolicy<Key, Value> {
+        public:
+            Hash_LIRS_Cache(size_t capacity, int sliceNum, double hirRatio = 0.01):
+                _capacity(capacity),
+                _sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) {
+                    size_t size = std::ceil(_capacity / static_cast<double>(_sliceNum));
+
+                    for (size_t i = 0; i < _sliceNum; i++) {
+                        _slicedCache.emplace_back(new LIRS_Cache<Key, Value>(size, hirRatio));
+                    }
+                }
+
+            Value get(Key key) {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->get(key, value);
+            }
+
+            void put(Key key, Value value) {
+                size_t index = Hash(key) % _sliceNum;
+                _slicedCache[index]->put(key, value);
+            }
+
+            void remove(Key key) {
+                size_t index = Hash(key) % _sliceNum;
+                _slicedCache[index]->remove(key);
+            }
+
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+        private:
+            size_t _capacity;
+            size_t _sliceNum;
+            std::vector<std::unique_ptr<LIRS_Cache<Key, Value>>> _slicedCache;
+
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+    };
+}
@@ -12,7 +12,7 @@ namespace CacheSpace {
 
             Key getKey() const { return _key; }
 
-            Value getValue() const { return _val; }
+            const Value& getValue() const { return _val; }
 
             void setValue(const Value& value) { _val = value; }
 
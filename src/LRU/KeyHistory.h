@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../CacheHash.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace CacheSpace {
+    // Bounded, value-free access history for admission policies such as LRU-K.
+    // Keys are reduced to 64-bit hashes; each is stored as a 32-bit tag in a
+    // 4-way set-associative table, and the least recently touched slot of a set
+    // is recycled when the set is full. Tag collisions can merge two keys'
+    // counts, which only makes admission slightly more eager.
+    //
+    // Not synchronized: callers hold their own lock.
+    template<typename Key>
+    class KeyHistory {
+        public:
+            static constexpr size_t WAYS = 4;
+
+            explicit KeyHistory(size_t capacity): _clock(0) {
+                size_t sets = 1;
+                while (sets * WAYS < capacity) sets <<= 1;
+                _setMask = sets - 1;
+                _slots.assign(sets * WAYS, Slot());
+            }
+
+            // Counts one more reference to `key` and returns the new count.
+            uint32_t touch(const Key& key) {
+                uint64_t hash = CacheHash<Key>()(key);
+                Slot* set = &_slots[(hash & _setMask) * WAYS];
+                uint32_t tag = tagOf(hash);
+
+                Slot* victim = set;
+                for (size_t i = 0; i < WAYS; i++) {
+                    if (set[i].tag == tag) {
+                        set[i].stamp = ++_clock;
+                        if (set[i].count != UINT32_MAX) set[i].count++;
+                        return set[i].count;
+                    }
+                    if (set[i].stamp < victim->stamp) victim = &set[i];
+                }
+
+                victim->tag = tag;
+                victim->count = 1;
+                victim->stamp = ++_clock;
+                return 1;
+            }
+
+            void erase(const Key& key) {
+                uint64_t hash = CacheHash<Key>()(key);
+                Slot* set = &_slots[(hash & _setMask) * WAYS];
+                uint32_t tag = tagOf(hash);
+
+                for (size_t i = 0; i < WAYS; i++) {
+                    if (set[i].tag == tag) {
+                        set[i] = Slot();
+                        return;
+                    }
+                }
+            }
+
+            void clear() {
+                _slots.assign(_slots.size(), Slot());
+                _clock = 0;
+            }
+
+            size_t capacity() const { return _slots.size(); }
+        private:
+            struct Slot {
+                uint32_t tag = 0;
+                uint32_t count = 0;
+                uint64_t stamp = 0;
+            };
+
+            size_t _setMask;
+            uint64_t _clock;
+            std::vector<Slot> _slots;
+
+            // Tag 0 marks an empty slot, so real tags are forced non-zero.
+            static uint32_t tagOf(uint64_t hash) {
+                uint32_t tag = static_cast<uint32_t>(hash >> 32);
+                return tag ? tag : 1;
+            }
+    };
+}
@@ -1,13 +1,20 @@
 #pragma once
 
 #include "CacheNode.h"
+#include "KeyHistory.h"
+#include "../CacheHash.h"
 #include "../CachePolicy.h"
+#include "../Reclaim/RetireList.h"
+#include "../Snapshot/Snapshot.h"
 
+#include <cmath>
 #include <mutex>
+#include <string>
 #include <vector>
 #include <thread>
 #include <memory>
-#include <cstring>
+#include <algorithm>
+#include <functional>
 #include <unordered_map>
 
 namespace CacheSpace {
@@ -17,14 +24,18 @@ namespace CacheSpace {
             using node_type = Node<Key, Value>;
             using node_ptr = std::shared_ptr<node_type>;
             using node_map = std::unordered_map<Key, node_ptr>;
+            using eviction_listener = std::function<void(const Key&, const Value&)>;
+            using batch_eviction_listener = typename EvictionBatch<Key, Value>::listener_type;
 
             LRU_Cache(int capacity): _capacity(capacity) {
                 initializeList();
             }
-            ~LRU_Cache() override = default;
+            ~LRU_Cache() override {
+                releaseList();
+            }
 
             Value get(Key key) override {
-                Value val;
+                Value val{};
                 get(key, val);
 
                 return val;
@@ -32,52 +43,183 @@ namespace CacheSpace {
 
             bool get(Key key, Value& value) override {
                 std::lock_guard<std::mutex> lock(_mutex);
-
-                if (_nodeRecords.count(key)) {
-                    moveToMostRecent(_nodeRecords[key]);
-                    value = _nodeRecords[key]->getValue();
-                    return true;
-                }
-                return false;
+                return getLocked(key, value);
             }
 
             void put(Key key, Value value) override {
+                typename EvictionBatch<Key, Value>::Scope retired(_evictionBatch);
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(RESIZE_STEP);
                 if (_capacity <= 0) return;
+                putLocked(key, value);
+            }
+
+            // Returns whether the key was cached.
+            bool remove(Key key) {
+                typename EvictionBatch<Key, Value>::Scope retired(_evictionBatch);
+                std::lock_guard<std::mutex> lock(_mutex);
+                return removeLocked(key);
+            }
+
+            // Takes effect at once for new entries. After a shrink, each put()
+            // evicts up to RESIZE_STEP of the surplus entries on top of its
+            // own victim, so the cache drains over later operations instead
+            // of in one long pass under the lock; trim() drains without a put.
+            void setCapacity(size_t capacity) {
                 std::lock_guard<std::mutex> lock(_mutex);
+                _capacity = static_cast<int>(capacity);
+            }
 
-                if (_nodeRecords.count(key)) {
-                    updateExistingNode(_nodeRecords[key], value);
-                    return;
-                }
+            // Evicts up to `maxEntries` surplus entries and returns how many
+            // are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                typename EvictionBatch<Key, Value>::Scope retired(_evictionBatch);
+                std::lock_guard<std::mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                return surplusLocked();
+            }
+
+            size_t capacity() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return static_cast<size_t>(std::max(_capacity, 0));
+            }
 
-                addNewNode(key, value);
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _nodeRecords.size();
             }
 
-            void remove(Key key) {
+            // Called with every entry dropped for capacity (not for remove()),
+            // under the cache lock.
+            void setEvictionListener(eviction_listener listener) {
                 std::lock_guard<std::mutex> lock(_mutex);
+                _evictionListener = std::move(listener);
+            }
 
-                if (_nodeRecords.count(key)) {
-                    removeNode(_nodeRecords[key]);
-                    _nodeRecords.erase(key);
+            // Called once per put() that evicted, with the evicted entries,
+            // after the cache lock has been released.
+            void setBatchEvictionListener(batch_eviction_listener listener) {
+                _evictionBatch.setListener(std::move(listener));
+            }
+
+            // Entries are stored from least to most recently used, together with
+            // their access counts. Only serialization happens under the lock.
+            bool saveSnapshot(const std::string& path) {
+                SnapshotWriter writer(SnapshotPolicy::LRU);
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+
+                    writer.write(static_cast<uint64_t>(_nodeRecords.size()));
+                    for (node_ptr node = _dummyHead->next; node != _dummyTail; node = node->next) {
+                        writer.write(node->_key);
+                        writer.write(node->_val);
+                        writer.write(static_cast<uint64_t>(node->_accessCnt));
+                    }
                 }
+                return writer.commit(path);
             }
 
-        private:
+            // Replaces the current contents with the snapshot in one bulk pass.
+            // If the snapshot holds more than `_capacity` entries, the least
+            // recent ones are dropped.
+            bool loadSnapshot(const std::string& path) {
+                SnapshotReader reader;
+                uint64_t count;
+                if (!reader.open(path, SnapshotPolicy::LRU) || !reader.read(count)) return false;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                _nodeRecords.clear();
+                initializeList();
+
+                uint64_t skip = count > static_cast<uint64_t>(std::max(_capacity, 0)) ? count - _capacity : 0;
+                _nodeRecords.reserve(count - skip);
+
+                Key key;
+                Value value;
+                uint64_t accessCnt;
+                for (uint64_t i = 0; i < count; i++) {
+                    if (!reader.read(key) || !reader.read(value) || !reader.read(accessCnt)) return false;
+                    if (i < skip) continue;
+
+                    node_ptr node = std::make_shared<node_type>(key, value);
+                    node->_accessCnt = accessCnt;
+                    _nodeRecords[key] = node;
+                    insertNode(node);
+                }
+                return reader.atEnd();
+            }
+
+        protected:
             int _capacity;
             std::mutex _mutex;
 
+            // Evicted entries and replaced values are moved here under the
+            // lock and destroyed by an EvictionBatch::Scope declared before
+            // the lock guard, i.e. after the lock is dropped.
+            EvictionBatch<Key, Value> _evictionBatch;
+
+            // Lock-free building blocks for subclasses that need several steps
+            // to happen under one acquisition of `_mutex`.
+            bool getLocked(const Key& key, Value& value) {
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end()) return false;
+
+                moveToMostRecent(it->second);
+                value = it->second->getValue();
+                return true;
+            }
+
+            bool updateLocked(const Key& key, const Value& value) {
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end()) return false;
+
+                updateExistingNode(it->second, value);
+                return true;
+            }
+
+            void putLocked(const Key& key, const Value& value) {
+                if (!updateLocked(key, value)) addNewNode(key, value);
+            }
+
+            void trimLocked(size_t maxEntries) {
+                for (size_t surplus = surplusLocked(); surplus > 0 && maxEntries > 0; surplus--, maxEntries--) {
+                    evictLeastRecent();
+                }
+            }
+
+            bool removeLocked(const Key& key) {
+                auto it = _nodeRecords.find(key);
+                if (it == _nodeRecords.end()) return false;
+
+                removeNode(it->second);
+                EvictionBatch<Key, Value>::released(it->second->_val);
+                _nodeRecords.erase(it);
+                return true;
+            }
+
+        private:
             node_ptr _dummyHead;
             node_ptr _dummyTail;
             node_map _nodeRecords;
+            eviction_listener _evictionListener;
 
             void initializeList() {
+                releaseList();
                 _dummyHead = std::make_shared<node_type>(Key(), Value());
                 _dummyTail = std::make_shared<node_type>(Key(), Value());
                 _dummyHead->next = _dummyTail;
                 _dummyTail->prev = _dummyHead;
             }
 
+            // Cuts the `next` links one by one; dropping the head of a long
+            // list would otherwise destroy it recursively and overflow the stack.
+            void releaseList() {
+                node_ptr node = std::move(_dummyHead);
+                while (node) node = std::move(node->next);
+            }
+
             void updateExistingNode(node_ptr node, const Value& value) {
+                EvictionBatch<Key, Value>::released(node->_val);
                 node->setValue(value);
                 moveToMostRecent(node);
             }
@@ -116,91 +258,138 @@ namespace CacheSpace {
                 insertNode(node);
             }
 
+            size_t surplusLocked() const {
+                size_t capacity = static_cast<size_t>(std::max(_capacity, 0));
+                return _nodeRecords.size() > capacity ? _nodeRecords.size() - capacity : 0;
+            }
+
             void evictLeastRecent() {
                 node_ptr node = _dummyHead->next;
                 _nodeRecords.erase(node->getKey());
                 removeNode(node);
+
+                if (_evictionListener) _evictionListener(node->_key, node->_val);
+                _evictionBatch.evicted(node->_key, node->_val);
             }
     };
 
+    // LRU-K admission: a key enters the cache only on its k-th reference. Only
+    // put() of an uncached key counts as a reference: callers fill a get()
+    // miss with a put(), so counting the miss as well would count one access
+    // twice and admit every key on its first reference when k = 2. The
+    // history keeps hashed keys and counts only (see KeyHistory), and every
+    // operation runs under a single acquisition of the base class lock.
     template<typename Key, typename Value>
     class LRU_K_Cache : public LRU_Cache<Key, Value> {
         public:
             LRU_K_Cache(int capacity, int historyCapacity, int k):
                 LRU_Cache<Key, Value>(capacity),
-                _pendingLists(std::make_unique<LRU_Cache<Key, size_t>>(historyCapacity)),
-                _k(k) {}
+                _k(std::max(k, 1)),
+                _history(std::max(historyCapacity, 1)) {}
 
-            Value get(Key key) {
-                Value result;
-                bool inCache = LRU_Cache<Key, Value>::get(key, result);
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
 
-                size_t historyCount = 0;
-                _pendingLists->get(key, historyCount);
-                historyCount++;
-                _pendingLists->put(key, historyCount);
+            bool get(Key key, Value& value) override {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+
+                return this->getLocked(key, value);
+            }
 
-                if (inCache) return result;
+            void put(Key key, Value value) override {
+                typename EvictionBatch<Key, Value>::Scope retired(this->_evictionBatch);
+                std::lock_guard<std::mutex> lock(this->_mutex);
 
-                if (_pendingMap.count(key) && historyCount >= _k) {
-                    result = _pendingMap[key];
-                    LRU_Cache<Key, Value>::put(key, result);
-                    _pendingLists->remove(key);
-                    _pendingMap.erase(key);
+                this->trimLocked(RESIZE_STEP);
+                if (this->_capacity <= 0) return;
+                if (this->updateLocked(key, value)) return;
+
+                if (_history.touch(key) >= static_cast<uint32_t>(_k)) {
+                    _history.erase(key);
+                    this->putLocked(key, value);
                 }
+            }
 
-                return result;
+            bool remove(Key key) {
+                typename EvictionBatch<Key, Value>::Scope retired(this->_evictionBatch);
+                std::lock_guard<std::mutex> lock(this->_mutex);
+
+                _history.erase(key);
+                return this->removeLocked(key);
             }
+        private:
+            int _k;
+            KeyHistory<Key> _history;
+    };
 
-            bool get(Key key, Value& value) {
-                if (LRU_Cache<Key, Value>::get(key, value)) return true;
-
-                size_t historyCount = 0;
-                if (_pendingLists->get(key, historyCount)) {
-                    historyCount++;
-                    _pendingLists->put(key, historyCount);
-
-                    if (_pendingMap.count(key) && historyCount >= static_cast<size_t>(_k)) {
-                        value = _pendingMap[key];
-                        LRU_Cache<Key, Value>::put(key, value);
-                        _pendingLists->remove(key);
-                        _pendingMap.erase(key);
-                        return true;
-                    }
+    template<typename Key, typename Value>
+    class Hash_LRU_K_Cache : public CachePolicy<Key, Value> {
+        public:
+            Hash_LRU_K_Cache(size_t capacity, size_t historyCapacity, int k, int sliceNum):
+                _capacity(capacity),
+                _sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) {
+                    size_t size = std::ceil(_capacity / static_cast<double>(_sliceNum));
+                    size_t historySize = std::ceil(historyCapacity / static_cast<double>(_sliceNum));
 
-                    if (_pendingMap.count(key)) {
-                        value = _pendingMap[key];
-                        return true;
+                    for (size_t i = 0; i < _sliceNum; i++) {
+                        _slicedCache.emplace_back(new LRU_K_Cache<Key, Value>(size, historySize, k));
                     }
                 }
-                return false;
+
+            Value get(Key key) {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->get(key, value);
             }
 
             void put(Key key, Value value) {
-                Value oldValue;
-                bool inCache = LRU_Cache<Key, Value>::get(key, oldValue);
+                size_t index = Hash(key) % _sliceNum;
+                _slicedCache[index]->put(key, value);
+            }
 
-                if (inCache) {
-                    LRU_Cache<Key, Value>::put(key, value);
-                    return;
-                }
+            bool remove(Key key) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->remove(key);
+            }
 
-                size_t pendingCnt = 0;
-                _pendingLists->get(key, pendingCnt);
-                pendingCnt++;
-                _pendingLists->put(key, pendingCnt);
-                _pendingMap[key] = value;
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
 
-                if (pendingCnt >= _k) {
-                    LRU_Cache<Key, Value>::put(key, value);
-                    _pendingLists->remove(key);
-                    _pendingMap.erase(key);
-                }
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
             }
         private:
-            int  _k;
-            std::unordered_map<Key, Value> _pendingMap;
-            std::unique_ptr<LRU_Cache<Key, size_t>> _pendingLists;
+            size_t _capacity;
+            size_t _sliceNum;
+            std::vector<std::unique_ptr<LRU_K_Cache<Key, Value>>> _slicedCache;
+
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
     };
 
     template<typename Key, typename Value>
@@ -212,13 +401,12 @@ namespace CacheSpace {
                     size_t size = std::ceil(_capacity / static_cast<double>(_sliceNum));
 
                     for (size_t i = 0; i < _sliceNum; i++) {
-                        _slicedCache.push_back(new LRU_Cache<Key, Value>(size));
+                        _slicedCache.emplace_back(new LRU_Cache<Key, Value>(size));
                     }
                 }
 
             Value get(Key key) {
-                Value result;
-                memset(&result, 0, sizeof(result));
+                Value result{};
                 get(key, result);
 
                 return result;
@@ -233,14 +421,51 @@ namespace CacheSpace {
                 size_t index = Hash(key) % _sliceNum;
                 _slicedCache[index]->put(key, value);
             }
+
+            bool remove(Key key) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->remove(key);
+            }
+
+            // Splits the new total evenly over the shards; see
+            // LRU_Cache::setCapacity for how a shrink is applied.
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+
+            void setEvictionListener(typename LRU_Cache<Key, Value>::eviction_listener listener) {
+                for (auto& cache : _slicedCache) cache->setEvictionListener(listener);
+            }
+
+            void setBatchEvictionListener(typename LRU_Cache<Key, Value>::batch_eviction_listener listener) {
+                for (auto& cache : _slicedCache) cache->setBatchEvictionListener(listener);
+            }
         private:
             int _sliceNum;
             size_t _capacity;
             std::vector<std::unique_ptr<LRU_Cache<Key, Value>>> _slicedCache;
 
-            size_t Hash(Key key) {
-                std::hash<Key> hashFunc;
-                return hashFunc(key);
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
             }
     };
 };
\ No newline at end of file
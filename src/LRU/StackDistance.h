@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // Mattson stack-distance engine: one pass over a key stream yields the exact
+    // LRU hit ratio for every capacity at once. Each access is treated as a
+    // demand-fill reference (a get that inserts on miss).
+    //
+    // The "stack" is kept as a Fenwick tree over last-access timestamps: a slot
+    // is set iff it holds the latest access of some key, so the number of set
+    // slots after a key's previous access is its reuse distance, in O(log n).
+    template<typename Key>
+    class LRU_StackDistance {
+        public:
+            static constexpr size_t COLD_MISS = 0;
+
+            explicit LRU_StackDistance(size_t initialSlots = 1024):
+                _clock(0), _accesses(0), _coldMisses(0) {
+                    resetTree(std::max<size_t>(initialSlots, 16), 0);
+                }
+
+            // Records one access and returns its stack distance (1 = most recent
+            // key), or COLD_MISS for the first reference to a key.
+            size_t access(const Key& key) {
+                if (_clock == _slots) compact();
+
+                size_t distance = COLD_MISS;
+                auto it = _lastAccess.find(key);
+
+                if (it != _lastAccess.end()) {
+                    size_t last = it->second;
+                    distance = prefixSum(_clock) - prefixSum(last + 1) + 1;
+                    update(last, -1);
+                    it->second = _clock;
+
+                    if (_histogram.size() <= distance) _histogram.resize(distance + 1, 0);
+                    _histogram[distance]++;
+                } else {
+                    _lastAccess.emplace(key, _clock);
+                    _coldMisses++;
+                }
+
+                update(_clock, 1);
+                _clock++;
+                _accesses++;
+                return distance;
+            }
+
+            template<typename Iter>
+            void accessAll(Iter first, Iter last) {
+                for (; first != last; ++first) access(*first);
+            }
+
+            uint64_t accessCount() const { return _accesses; }
+
+            uint64_t coldMissCount() const { return _coldMisses; }
+
+            size_t distinctKeys() const { return _lastAccess.size(); }
+
+            uint64_t hits(size_t capacity) const {
+                uint64_t total = 0;
+                size_t limit = std::min(capacity, _histogram.empty() ? 0 : _histogram.size() - 1);
+
+                for (size_t d = 1; d <= limit; d++) total += _histogram[d];
+                return total;
+            }
+
+            double hitRatio(size_t capacity) const {
+                return _accesses == 0 ? 0.0 : static_cast<double>(hits(capacity)) / _accesses;
+            }
+
+            // curve[c] is the hit ratio of an LRU cache holding c entries, for
+            // every c in [0, maxCapacity].
+            std::vector<double> hitRatioCurve(size_t maxCapacity) const {
+                std::vector<double> curve(maxCapacity + 1, 0.0);
+                if (_accesses == 0) return curve;
+
+                uint64_t total = 0;
+                for (size_t c = 1; c <= maxCapacity; c++) {
+                    if (c < _histogram.size()) total += _histogram[c];
+                    curve[c] = static_cast<double>(total) / _accesses;
+                }
+                return curve;
+            }
+
+            const std::vector<uint64_t>& histogram() const { return _histogram; }
+
+            void reset() {
+                _lastAccess.clear();
+                _histogram.clear();
+                _accesses = 0;
+                _coldMisses = 0;
+                resetTree(_slots, 0);
+            }
+        private:
+            size_t _slots;
+            size_t _clock;
+            uint64_t _accesses;
+            uint64_t _coldMisses;
+
+            std::vector<int> _tree;
+            std::vector<uint64_t> _histogram;
+            std::unordered_map<Key, size_t> _lastAccess;
+
+            // Number of live timestamps in [0, end).
+            size_t prefixSum(size_t end) const {
+                long sum = 0;
+                for (size_t i = end; i > 0; i -= i & (~i + 1)) sum += _tree[i];
+                return static_cast<size_t>(sum);
+            }
+
+            void update(size_t pos, int delta) {
+                for (size_t i = pos + 1; i <= _slots; i += i & (~i + 1)) _tree[i] += delta;
+            }
+
+            // Fills slots [0, live) with ones in O(slots).
+            void resetTree(size_t slots, size_t live) {
+                _slots = slots;
+                _clock = live;
+                _tree.assign(_slots + 1, 0);
+
+                for (size_t i = 1; i <= _slots; i++) {
+                    if (i <= live) _tree[i] += 1;
+                    size_t parent = i + (i & (~i + 1));
+                    if (parent <= _slots) _tree[parent] += _tree[i];
+                }
+            }
+
+            // Timestamps are renumbered densely in access order once the tree is
+            // full, so memory stays proportional to the number of distinct keys.
+            void compact() {
+                std::vector<std::pair<size_t, Key>> order;
+                order.reserve(_lastAccess.size());
+                for (const auto& entry : _lastAccess) order.emplace_back(entry.second, entry.first);
+                std::sort(order.begin(), order.end(),
+                    [](const std::pair<size_t, Key>& a, const std::pair<size_t, Key>& b) {
+                        return a.first < b.first;
+                    });
+
+                for (size_t i = 0; i < order.size(); i++) _lastAccess[order[i].second] = i;
+
+                size_t live = order.size();
+                resetTree(std::max(_slots, live * 2), live);
+            }
+    };
+}
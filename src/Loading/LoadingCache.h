@@ -0,0 +1,221 @@
+#pragma once
+
+#include "NegativeFilter.h"
+#include "StridePredictor.h"
+#include "../CachePolicy.h"
+#include "../LRU/LRUCache.h"
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+namespace CacheSpace {
+    struct LoadingOptions {
+        PrefetchOptions prefetch;
+        NegativeOptions negative;
+    };
+
+    // Read-through cache: a miss calls `loader` and stores the result in
+    // MainCache. For integral keys, misses are also fed per calling thread to
+    // a StridePredictor; once it is confident, the keys ahead of the stream
+    // are loaded by a background thread (through `batchLoader` when given)
+    // into a separate prefetch LRU. A prefetched key only enters MainCache
+    // when it is first read, so a wrong guess never displaces real entries.
+    //
+    // With `negative.expectedKeys` set, keys the loader reports absent are
+    // remembered in a NegativeFilter and later misses on them return false
+    // without calling the loader. put()/remove() erase the key from it.
+    //
+    // Loaded values are stored only if no write happened while they were being
+    // loaded (a write-epoch check under `_writeMutex`), so neither a demand
+    // load nor a prefetch can bring back a value older than a put().
+    template<typename Key, typename Value, typename MainCache = LRU_Cache<Key, Value>>
+    class Loading_Cache : public CachePolicy<Key, Value> {
+        public:
+            using loader_type = std::function<bool(const Key&, Value&)>;
+            using batch_loader_type = std::function<void(const std::vector<Key>&, std::vector<std::pair<Key, Value>>&)>;
+
+            template<typename... Args>
+            Loading_Cache(loader_type loader, batch_loader_type batchLoader,
+                          const LoadingOptions& options, Args&&... mainArgs):
+                _main(std::make_unique<MainCache>(std::forward<Args>(mainArgs)...)),
+                _prefetched(std::make_unique<LRU_Cache<Key, Value>>(static_cast<int>(options.prefetch.prefetchCapacity))),
+                _loader(std::move(loader)),
+                _batchLoader(std::move(batchLoader)),
+                _predictor(options.prefetch),
+                _stop(false),
+                _writeEpoch(0),
+                _loads(0),
+                _prefetchLoads(0),
+                _prefetchHits(0),
+                _negativeHits(0) {
+                    if (options.negative.expectedKeys > 0) {
+                        _negative = std::make_unique<NegativeFilter<Key>>(options.negative);
+                    }
+                    if (std::is_integral<Key>::value && options.prefetch.depth > 0) {
+                        _worker = std::thread([this]() { prefetchLoop(); });
+                    }
+                }
+
+            ~Loading_Cache() override {
+                {
+                    std::lock_guard<std::mutex> lock(_queueMutex);
+                    _stop = true;
+                }
+                _queueReady.notify_all();
+                if (_worker.joinable()) _worker.join();
+            }
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                if (_main->get(key, value)) return true;
+
+                predict(key);
+                {
+                    std::lock_guard<std::mutex> lock(_writeMutex);
+                    if (_prefetched->get(key, value)) {
+                        _prefetched->remove(key);
+                        _main->put(key, value);
+                        _prefetchHits++;
+                        return true;
+                    }
+                }
+
+                if (_negative && _negative->mayContain(key)) {
+                    _negativeHits++;
+                    return false;
+                }
+
+                _loads++;
+                uint64_t epoch = _writeEpoch.load(std::memory_order_acquire);
+                bool found = _loader(key, value);
+
+                std::lock_guard<std::mutex> lock(_writeMutex);
+                if (_writeEpoch.load(std::memory_order_relaxed) == epoch) {
+                    if (found) _main->put(key, value);
+                    else if (_negative) _negative->insert(key);
+                }
+                return found;
+            }
+
+            void put(Key key, Value value) override {
+                {
+                    std::lock_guard<std::mutex> lock(_writeMutex);
+                    _writeEpoch.fetch_add(1, std::memory_order_acq_rel);
+                    _prefetched->remove(key);
+                    if (_negative) _negative->erase(key);
+                }
+                _main->put(key, value);
+            }
+
+            void remove(Key key) {
+                {
+                    std::lock_guard<std::mutex> lock(_writeMutex);
+                    _writeEpoch.fetch_add(1, std::memory_order_acq_rel);
+                    _prefetched->remove(key);
+                    if (_negative) _negative->erase(key);
+                }
+                _main->remove(key);
+            }
+
+            // Demand loads, i.e. misses the prefetcher did not cover.
+            size_t loads() const { return _loads.load(std::memory_order_relaxed); }
+
+            size_t prefetchLoads() const { return _prefetchLoads.load(std::memory_order_relaxed); }
+
+            size_t prefetchHits() const { return _prefetchHits.load(std::memory_order_relaxed); }
+
+            // Misses answered by the negative filter without a load.
+            size_t negativeHits() const { return _negativeHits.load(std::memory_order_relaxed); }
+        private:
+            std::unique_ptr<MainCache> _main;
+            std::unique_ptr<LRU_Cache<Key, Value>> _prefetched;
+            loader_type _loader;
+            batch_loader_type _batchLoader;
+
+            std::mutex _predictorMutex;
+            StridePredictor _predictor;
+            std::unique_ptr<NegativeFilter<Key>> _negative;
+
+            std::mutex _queueMutex;
+            std::condition_variable _queueReady;
+            std::deque<std::vector<Key>> _queue;
+            bool _stop;
+            std::thread _worker;
+
+            std::mutex _writeMutex;
+            std::atomic<uint64_t> _writeEpoch;
+            std::atomic<size_t> _loads;
+            std::atomic<size_t> _prefetchLoads;
+            std::atomic<size_t> _prefetchHits;
+            std::atomic<size_t> _negativeHits;
+
+            void predict(const Key& key) {
+                if constexpr (std::is_integral<Key>::value) {
+                    if (!_worker.joinable()) return;
+
+                    int64_t first, stride;
+                    size_t count;
+                    {
+                        std::lock_guard<std::mutex> lock(_predictorMutex);
+                        size_t stream = std::hash<std::thread::id>()(std::this_thread::get_id());
+                        if (!_predictor.recordMiss(stream, static_cast<int64_t>(key), first, stride, count)) return;
+                    }
+
+                    std::vector<Key> batch;
+                    batch.reserve(count);
+                    for (size_t i = 0; i < count; i++) batch.push_back(static_cast<Key>(first + stride * static_cast<int64_t>(i)));
+                    {
+                        std::lock_guard<std::mutex> lock(_queueMutex);
+                        _queue.push_back(std::move(batch));
+                    }
+                    _queueReady.notify_one();
+                } else {
+                    (void)key;
+                }
+            }
+
+            void prefetchLoop() {
+                std::vector<std::pair<Key, Value>> results;
+                while (true) {
+                    std::vector<Key> batch;
+                    {
+                        std::unique_lock<std::mutex> lock(_queueMutex);
+                        _queueReady.wait(lock, [this]() { return _stop || !_queue.empty(); });
+                        if (_stop) return;
+                        batch = std::move(_queue.front());
+                        _queue.pop_front();
+                    }
+
+                    uint64_t epoch = _writeEpoch.load(std::memory_order_acquire);
+                    results.clear();
+                    if (_batchLoader) {
+                        _batchLoader(batch, results);
+                    } else {
+                        Value value;
+                        for (const Key& key : batch) {
+                            if (_loader(key, value)) results.emplace_back(key, value);
+                        }
+                    }
+                    std::lock_guard<std::mutex> lock(_writeMutex);
+                    if (_writeEpoch.load(std::memory_order_relaxed) != epoch) continue;
+
+                    for (auto& result : results) _prefetched->put(result.first, result.second);
+                    _prefetchLoads += results.size();
+                }
+            }
+    };
+}
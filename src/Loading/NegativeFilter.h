@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../CacheHash.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace CacheSpace {
+    struct NegativeOptions {
+        size_t expectedKeys = 0;            // absent keys per generation; 0 disables
+        double falsePositiveRate = 0.01;    // per generation
+        uint64_t lifetimeMs = 60000;        // how long an absent key is remembered
+        uint32_t generations = 2;
+    };
+
+    // Remembers keys the backing store confirmed absent. A blocked Bloom
+    // filter: each key maps to one 64-byte block and sets k bits inside it,
+    // so a lookup touches one cache line per generation.
+    //
+    // Time partitioning: keys are added to the newest generation, and every
+    // lifetime / generations the oldest one is cleared and becomes the
+    // newest, so a key is forgotten after at most `lifetimeMs`.
+    //
+    // erase() clears the key's bits in every generation. Other keys sharing
+    // those bits are forgotten too, which only costs a backend lookup; the
+    // erased key itself can never be reported absent afterwards.
+    template<typename Key>
+    class NegativeFilter {
+        public:
+            explicit NegativeFilter(const NegativeOptions& options):
+                _generations(std::max<uint32_t>(options.generations, 2)),
+                _current(0),
+                _period(std::chrono::milliseconds(std::max<uint64_t>(options.lifetimeMs / _generations, 1))),
+                _nextRotation((clock::now() + _period).time_since_epoch().count()) {
+                    double n = static_cast<double>(std::max<size_t>(options.expectedKeys, 1));
+                    double p = std::min(std::max(options.falsePositiveRate, 1e-6), 0.5);
+                    double bits = -n * std::log(p) / (std::log(2.0) * std::log(2.0));
+
+                    _blocks = std::max<size_t>(static_cast<size_t>(std::ceil(bits / BLOCK_BITS)), 1);
+                    _hashes = static_cast<uint32_t>(std::min(std::max(std::round(bits / n * std::log(2.0)), 1.0), 16.0));
+                    _words.reset(new std::atomic<uint64_t>[_generations * _blocks * BLOCK_WORDS]);
+                    for (size_t i = 0; i < _generations * _blocks * BLOCK_WORDS; i++) _words[i].store(0, std::memory_order_relaxed);
+                }
+
+            bool mayContain(const Key& key) {
+                rotateIfDue();
+                Probe probe(*this, key);
+                for (uint32_t g = 0; g < _generations; g++) {
+                    std::atomic<uint64_t>* block = blockAt(g, probe.block);
+                    bool all = true;
+                    for (uint32_t i = 0; i < _hashes && all; i++) {
+                        uint32_t bit = probe.bit(i);
+                        all = block[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64));
+                    }
+                    if (all) return true;
+                }
+                return false;
+            }
+
+            void insert(const Key& key) {
+                rotateIfDue();
+                Probe probe(*this, key);
+                std::atomic<uint64_t>* block = blockAt(_current.load(std::memory_order_acquire), probe.block);
+                for (uint32_t i = 0; i < _hashes; i++) {
+                    uint32_t bit = probe.bit(i);
+                    block[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+                }
+            }
+
+            void erase(const Key& key) {
+                Probe probe(*this, key);
+                for (uint32_t g = 0; g < _generations; g++) {
+                    std::atomic<uint64_t>* block = blockAt(g, probe.block);
+                    for (uint32_t i = 0; i < _hashes; i++) {
+                        uint32_t bit = probe.bit(i);
+                        block[bit / 64].fetch_and(~(uint64_t(1) << (bit % 64)), std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            size_t bytes() const { return _generations * _blocks * BLOCK_WORDS * sizeof(uint64_t); }
+        private:
+            using clock = std::chrono::steady_clock;
+            static constexpr uint32_t BLOCK_WORDS = 8;
+            static constexpr uint32_t BLOCK_BITS = BLOCK_WORDS * 64;
+
+            // Block index from the high hash bits, bit positions by double
+            // hashing on the low ones.
+            struct Probe {
+                size_t block;
+                uint32_t h1, h2;
+
+                Probe(const NegativeFilter& filter, const Key& key) {
+                    uint64_t hash = CacheHash<Key>()(key);
+                    block = static_cast<size_t>((hash >> 32) % filter._blocks);
+                    h1 = static_cast<uint32_t>(hash);
+                    h2 = static_cast<uint32_t>(hash >> 16) | 1;
+                }
+
+                uint32_t bit(uint32_t i) const { return (h1 + i * h2) % BLOCK_BITS; }
+            };
+
+            uint32_t _generations;
+            size_t _blocks;
+            uint32_t _hashes;
+            std::unique_ptr<std::atomic<uint64_t>[]> _words;
+
+            std::mutex _rotateMutex;
+            std::atomic<uint32_t> _current;
+            clock::duration _period;
+            std::atomic<clock::rep> _nextRotation;
+
+            std::atomic<uint64_t>* blockAt(uint32_t generation, size_t block) {
+                return &_words[(generation * _blocks + block) * BLOCK_WORDS];
+            }
+
+            void rotateIfDue() {
+                clock::rep now = clock::now().time_since_epoch().count();
+                if (now < _nextRotation.load(std::memory_order_relaxed)) return;
+
+                std::unique_lock<std::mutex> lock(_rotateMutex, std::try_to_lock);
+                if (!lock.owns_lock()) return;
+                // After an idle spell longer than the lifetime everything has expired.
+                if (now - _nextRotation.load(std::memory_order_relaxed) >= _period.count() * _generations) {
+                    for (size_t i = 0; i < _generations * _blocks * BLOCK_WORDS; i++) _words[i].store(0, std::memory_order_relaxed);
+                    _nextRotation.store(now + _period.count(), std::memory_order_relaxed);
+                    return;
+                }
+                while (now >= _nextRotation.load(std::memory_order_relaxed)) {
+                    uint32_t oldest = (_current.load(std::memory_order_relaxed) + 1) % _generations;
+                    std::atomic<uint64_t>* words = blockAt(oldest, 0);
+                    for (size_t i = 0; i < _blocks * BLOCK_WORDS; i++) words[i].store(0, std::memory_order_relaxed);
+                    _current.store(oldest, std::memory_order_release);
+                    _nextRotation.fetch_add(_period.count(), std::memory_order_relaxed);
+                }
+            }
+    };
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace CacheSpace {
+    struct PrefetchOptions {
+        size_t depth = 16;              // keys fetched ahead once confident
+        uint32_t confidence = 2;        // repeated strides before prefetching
+        size_t prefetchCapacity = 256;  // entries held until first use
+    };
+
+    // Stride detection over one caller stream's misses. A stream that misses
+    // on k, k+s, k+2s... builds confidence in stride s; once confident, each
+    // miss asks for the keys up to `depth` strides ahead that have not been
+    // requested yet. Batches are issued when half of that window has been
+    // used up, so a steady scan costs one batch load per `depth / 2` keys.
+    //
+    // Not synchronized: callers hold their own lock.
+    class StridePredictor {
+        public:
+            explicit StridePredictor(const PrefetchOptions& options): _options(options) {}
+
+            // Records a miss on `key` for `stream` and returns the range of keys
+            // to prefetch as [first, first + count * stride).
+            bool recordMiss(size_t stream, int64_t key, int64_t& first, int64_t& stride, size_t& count) {
+                State& state = _streams[stream % STREAMS];
+                int64_t delta = key - state.last;
+
+                if (state.seen && delta != 0 && delta == state.stride) {
+                    if (state.hits < _options.confidence) state.hits++;
+                } else {
+                    state.stride = delta;
+                    state.hits = 0;
+                    state.ahead = key;
+                }
+                state.last = key;
+                state.seen = true;
+
+                if (state.hits < _options.confidence || _options.depth == 0) return false;
+
+                // Continue from whatever was already requested for this run, and
+                // only once less than half of `depth` is still outstanding.
+                int64_t depth = static_cast<int64_t>(_options.depth);
+                int64_t limit = key + state.stride * depth;
+                int64_t next = behind(state.ahead, key, state.stride) ? key + state.stride : state.ahead + state.stride;
+                if (!behind(next, key + state.stride * (depth / 2 + 1), state.stride)) return false;
+
+                first = next;
+                stride = state.stride;
+                count = static_cast<size_t>((limit - next) / state.stride + 1);
+                state.ahead = limit;
+                return true;
+            }
+        private:
+            static constexpr size_t STREAMS = 16;
+
+            struct State {
+                int64_t last = 0;
+                int64_t stride = 0;
+                int64_t ahead = 0;
+                uint32_t hits = 0;
+                bool seen = false;
+            };
+
+            PrefetchOptions _options;
+            std::array<State, STREAMS> _streams;
+
+            // True if `a` comes before `b` walking in the direction of `stride`.
+            static bool behind(int64_t a, int64_t b, int64_t stride) {
+                return stride > 0 ? a < b : a > b;
+            }
+    };
+}
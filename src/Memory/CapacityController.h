@@ -0,0 +1,240 @@
+#pragma once
+
+#include "MemoryUsage.h"
+#include "../CachePolicy.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace CacheSpace {
+    struct PressureOptions {
+        uint64_t limitBytes = 0;        // 0: the cgroup limit, or physical memory outside one
+        double lowWatermark = 0.70;     // caches grow while usage is below this share of the limit
+        double highWatermark = 0.85;    // and shrink while it is above this one
+        double maxStep = 0.25;          // largest capacity change per tick, as a share of the capacity
+        uint64_t intervalMs = 500;      // tick period of the background thread
+    };
+
+    // Resizes registered caches to keep memory usage inside a band below a
+    // limit. Each tick reads usage (the cgroup working set when a cgroup
+    // limit applies, otherwise this process's RSS) and:
+    //   - above the high watermark, takes the excess over the middle of the
+    //     band out of the caches in proportion to their estimated footprint
+    //     (entries x bytesPerEntry), then drains them with trim() batches
+    //     and returns freed heap pages to the kernel;
+    //   - below the low watermark, splits the headroom between the caches
+    //     that are full, i.e. still evicting;
+    //   - in between, leaves everything as it is, so capacity does not
+    //     oscillate around a single threshold.
+    // No step changes a capacity by more than `maxStep` of it, and every
+    // cache stays within its registered [minCapacity, maxCapacity].
+    //
+    // Any cache with setCapacity / capacity / size / trim can be registered
+    // (Hash_LRU_Cache, Hash_LFU_Cache, ARC_Cache, ...); it must outlive its
+    // registration.
+    class Capacity_Controller {
+        public:
+            enum class Action { Hold, Shrink, Grow };
+
+            explicit Capacity_Controller(const PressureOptions& options = PressureOptions()):
+                _options(options),
+                _nextId(0),
+                _shrinks(0),
+                _grows(0),
+                _stop(false) {}
+
+            ~Capacity_Controller() {
+                stop();
+            }
+
+            Capacity_Controller(const Capacity_Controller&) = delete;
+            Capacity_Controller& operator=(const Capacity_Controller&) = delete;
+
+            // `bytesPerEntry` is the caller's estimate of one entry's memory:
+            // key, value payload and the policy's per-entry bookkeeping.
+            template<typename Cache>
+            int registerCache(Cache& cache, size_t minCapacity, size_t maxCapacity, size_t bytesPerEntry) {
+                Registered entry;
+                entry.minCapacity = minCapacity;
+                entry.maxCapacity = std::max(minCapacity, maxCapacity);
+                entry.bytesPerEntry = std::max<size_t>(bytesPerEntry, 1);
+                entry.setCapacity = [&cache](size_t capacity) { cache.setCapacity(capacity); };
+                entry.capacity = [&cache]() { return cache.capacity(); };
+                entry.size = [&cache]() { return cache.size(); };
+                entry.trim = [&cache](size_t maxEntries) { return cache.trim(maxEntries); };
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                entry.id = _nextId++;
+                _caches.push_back(std::move(entry));
+                return _caches.back().id;
+            }
+
+            void unregisterCache(int id) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _caches.erase(std::remove_if(_caches.begin(), _caches.end(),
+                    [id](const Registered& entry) { return entry.id == id; }), _caches.end());
+            }
+
+            void start() {
+                std::lock_guard<std::mutex> lock(_threadMutex);
+                if (_worker.joinable()) return;
+                _stop = false;
+                _worker = std::thread([this]() { run(); });
+            }
+
+            void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(_threadMutex);
+                    _stop = true;
+                }
+                _wake.notify_all();
+                if (_worker.joinable()) _worker.join();
+            }
+
+            // One control step, also usable without the background thread.
+            Action tick() {
+                uint64_t used, limit;
+                measure(used, limit);
+                uint64_t low = static_cast<uint64_t>(limit * _options.lowWatermark);
+                uint64_t high = static_cast<uint64_t>(limit * _options.highWatermark);
+                uint64_t target = low / 2 + high / 2;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (used > high && shrinkBy(used - target)) {
+                    _shrinks++;
+                    return Action::Shrink;
+                }
+                if (used < low && growBy(target - used)) {
+                    _grows++;
+                    return Action::Grow;
+                }
+                return Action::Hold;
+            }
+
+            // Bytes in use and the limit the watermarks apply to.
+            void measure(uint64_t& used, uint64_t& limit) const {
+                MemoryUsage usage = _probe.read();
+                if (_options.limitBytes) {
+                    limit = _options.limitBytes;
+                    used = usage.rssBytes;
+                } else if (usage.cgroupLimit) {
+                    limit = usage.cgroupLimit;
+                    used = usage.cgroupBytes;
+                } else {
+                    limit = usage.physicalBytes;
+                    used = usage.rssBytes;
+                }
+            }
+
+            // Sum of entries x bytesPerEntry over the registered caches.
+            uint64_t estimatedCacheBytes() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                uint64_t total = 0;
+                for (const auto& entry : _caches) total += entry.size() * entry.bytesPerEntry;
+                return total;
+            }
+
+            size_t shrinks() const { return _shrinks.load(std::memory_order_relaxed); }
+
+            size_t grows() const { return _grows.load(std::memory_order_relaxed); }
+        private:
+            struct Registered {
+                int id;
+                size_t minCapacity;
+                size_t maxCapacity;
+                size_t bytesPerEntry;
+                std::function<void(size_t)> setCapacity;
+                std::function<size_t()> capacity;
+                std::function<size_t()> size;
+                std::function<size_t(size_t)> trim;
+            };
+
+            PressureOptions _options;
+            MemoryProbe _probe;
+
+            std::mutex _mutex;
+            std::vector<Registered> _caches;
+            int _nextId;
+            std::atomic<size_t> _shrinks;
+            std::atomic<size_t> _grows;
+
+            std::mutex _threadMutex;
+            std::condition_variable _wake;
+            bool _stop;
+            std::thread _worker;
+
+            size_t stepOf(size_t capacity) const {
+                return std::max<size_t>(1, static_cast<size_t>(capacity * _options.maxStep));
+            }
+
+            // A cache that is not full frees nothing when its capacity drops
+            // to its size, so cuts are taken from min(size, capacity).
+            bool shrinkBy(uint64_t excess) {
+                uint64_t footprint = 0;
+                for (const auto& entry : _caches) footprint += entry.size() * entry.bytesPerEntry;
+                if (footprint == 0) return false;
+
+                bool changed = false;
+                for (auto& entry : _caches) {
+                    size_t capacity = entry.capacity();
+                    size_t base = std::min(capacity, entry.size());
+                    double share = static_cast<double>(base) * entry.bytesPerEntry / footprint;
+                    size_t cut = static_cast<size_t>(excess * share / entry.bytesPerEntry) + 1;
+                    cut = std::min(cut, stepOf(base));
+
+                    size_t next = std::max(entry.minCapacity, base > cut ? base - cut : 0);
+                    if (next >= capacity) continue;
+                    entry.setCapacity(next);
+                    // Short batches: the cache lock is released between them.
+                    while (entry.trim(RESIZE_STEP * 16) > 0) {}
+                    changed = true;
+                }
+#if defined(__GLIBC__)
+                if (changed) malloc_trim(0);
+#endif
+                return changed;
+            }
+
+            bool growBy(uint64_t headroom) {
+                std::vector<Registered*> full;
+                for (auto& entry : _caches) {
+                    size_t capacity = entry.capacity();
+                    if (capacity < entry.maxCapacity && entry.size() * 10 >= capacity * 9) full.push_back(&entry);
+                }
+                if (full.empty()) return false;
+
+                bool changed = false;
+                for (Registered* entry : full) {
+                    size_t capacity = entry->capacity();
+                    size_t add = static_cast<size_t>(headroom / full.size() / entry->bytesPerEntry);
+                    add = std::min(add, stepOf(capacity));
+                    if (add == 0) continue;
+                    entry->setCapacity(std::min(entry->maxCapacity, capacity + add));
+                    changed = true;
+                }
+                return changed;
+            }
+
+            void run() {
+                std::unique_lock<std::mutex> lock(_threadMutex);
+                while (!_stop) {
+                    lock.unlock();
+                    tick();
+                    lock.lock();
+                    _wake.wait_for(lock, std::chrono::milliseconds(_options.intervalMs), [this]() { return _stop; });
+                }
+            }
+    };
+}
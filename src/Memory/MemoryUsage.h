@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace CacheSpace {
+    struct MemoryUsage {
+        uint64_t rssBytes = 0;          // resident set of this process
+        uint64_t cgroupBytes = 0;       // cgroup working set; 0 outside a limited cgroup
+        uint64_t cgroupLimit = 0;       // cgroup memory limit; 0 when unlimited
+        uint64_t physicalBytes = 0;     // RAM on the host
+    };
+
+    // Reads memory figures from procfs and the cgroup filesystem. The cgroup
+    // working set is usage minus inactive file pages, as container runtimes
+    // compute it: page cache the kernel reclaims before hitting the limit is
+    // not counted. cgroup v2
+    // (memory.current / memory.max) is tried first, then v1
+    // (memory.usage_in_bytes / memory.limit_in_bytes).
+    class MemoryProbe {
+        public:
+            MemoryProbe(): _pageSize(static_cast<uint64_t>(sysconf(_SC_PAGESIZE))) {
+                locateCgroup();
+            }
+
+            MemoryUsage read() const {
+                MemoryUsage usage;
+                uint64_t pages = 0, resident = 0;
+                std::ifstream statm("/proc/self/statm");
+                if (statm >> pages >> resident) usage.rssBytes = resident * _pageSize;
+                usage.physicalBytes = static_cast<uint64_t>(sysconf(_SC_PHYS_PAGES)) * _pageSize;
+
+                if (_cgroupDir.empty()) return usage;
+                uint64_t limit = 0, current = 0;
+                if (!readNumber(_cgroupDir + (_v2 ? "/memory.max" : "/memory.limit_in_bytes"), limit) ||
+                    !readNumber(_cgroupDir + (_v2 ? "/memory.current" : "/memory.usage_in_bytes"), current)) {
+                    return usage;
+                }
+                // v2 writes "max", v1 a page-rounded INT64_MAX, for no limit.
+                if (limit == 0 || limit >= (uint64_t(1) << 60)) return usage;
+
+                uint64_t inactive = statField(_v2 ? "inactive_file" : "total_inactive_file");
+                usage.cgroupLimit = limit;
+                usage.cgroupBytes = current > inactive ? current - inactive : 0;
+                return usage;
+            }
+        private:
+            uint64_t _pageSize;
+            std::string _cgroupDir;
+            bool _v2 = false;
+
+            static bool readNumber(const std::string& path, uint64_t& value) {
+                std::ifstream in(path);
+                std::string text;
+                if (!(in >> text)) return false;
+                value = text == "max" ? 0 : std::strtoull(text.c_str(), nullptr, 10);
+                return true;
+            }
+
+            static bool exists(const std::string& path) {
+                return access(path.c_str(), R_OK) == 0;
+            }
+
+            // The process's own cgroup directory when it is visible in this
+            // mount namespace, else the root of the mount (a container sees
+            // its cgroup there).
+            void locateCgroup() {
+                std::ifstream in("/proc/self/cgroup");
+                std::string line, v2Path, v1Path;
+                while (std::getline(in, line)) {
+                    size_t first = line.find(':'), second = line.find(':', first + 1);
+                    if (first == std::string::npos || second == std::string::npos) continue;
+                    std::string controllers = line.substr(first + 1, second - first - 1);
+                    std::string path = line.substr(second + 1);
+                    if (line.compare(0, first, "0") == 0 && controllers.empty()) v2Path = path;
+                    else if (("," + controllers + ",").find(",memory,") != std::string::npos) v1Path = path;
+                }
+
+                for (const std::string& dir : {"/sys/fs/cgroup" + v2Path, std::string("/sys/fs/cgroup")}) {
+                    if (exists(dir + "/memory.max")) {
+                        _cgroupDir = dir;
+                        _v2 = true;
+                        return;
+                    }
+                }
+                for (const std::string& dir : {"/sys/fs/cgroup/memory" + v1Path, std::string("/sys/fs/cgroup/memory")}) {
+                    if (exists(dir + "/memory.limit_in_bytes")) {
+                        _cgroupDir = dir;
+                        return;
+                    }
+                }
+            }
+
+            uint64_t statField(const std::string& name) const {
+                std::ifstream in(_cgroupDir + "/memory.stat");
+                std::string key;
+                uint64_t value;
+                while (in >> key >> value) {
+                    if (key == name) return value;
+                }
+                return 0;
+            }
+    };
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+namespace CacheSpace {
+    struct NearCacheOptions {
+        size_t slots = 256;                            // per-thread L1 entries
+        size_t stripes = 64;                           // write epochs
+        std::chrono::microseconds maxStaleness{0};     // 0: epochs only
+    };
+
+    // Small per-thread L1 in front of a shared (typically sharded) cache. Each
+    // thread keeps a direct-mapped table of recently read entries, tagged with
+    // the write epoch of the key's stripe at the time of the read. Writes made
+    // through this object bump that epoch seqlock-style (odd while the write
+    // is in flight), so every thread's copies in the stripe go stale at once.
+    // A hot-key read that hits L1 only loads the epoch, a line that stays
+    // shared until someone writes to the stripe.
+    //
+    // Writes made directly to the backing cache are not seen by the epochs;
+    // set maxStaleness to bound how long such a value can be served.
+    template<typename Key, typename Value, typename Backing>
+    class Near_Cache : public CachePolicy<Key, Value> {
+        public:
+            Near_Cache(Backing& backing, const NearCacheOptions& options = NearCacheOptions()):
+                _backing(backing),
+                _slotMask(roundUp(options.slots) - 1),
+                _stripeMask(roundUp(options.stripes) - 1),
+                _maxStaleness(std::chrono::duration_cast<std::chrono::steady_clock::duration>(options.maxStaleness)),
+                _epochs(_stripeMask + 1),
+                _id(nextId()) {}
+            ~Near_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                size_t hash = CacheHash<Key>()(key);
+                std::atomic<uint64_t>& epoch = _epochs[hash & _stripeMask].value;
+                Slot& slot = localTable()[hash & _slotMask];
+
+                uint64_t before = epoch.load(std::memory_order_acquire);
+                if (slot.valid && slot.epoch == before && slot.key == key && fresh(slot)) {
+                    value = slot.value;
+                    return true;
+                }
+
+                if (!_backing.get(key, value)) return false;
+
+                // Only cache if no write to the stripe started or finished
+                // while we were reading the backing cache.
+                if ((before & 1) == 0 && epoch.load(std::memory_order_acquire) == before) {
+                    slot.key = key;
+                    slot.value = value;
+                    slot.epoch = before;
+                    slot.valid = true;
+                    if (_maxStaleness.count() > 0) slot.stamp = std::chrono::steady_clock::now();
+                }
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                std::atomic<uint64_t>& epoch = stripeOf(key);
+                epoch.fetch_add(1, std::memory_order_acq_rel);
+                _backing.put(key, value);
+                epoch.fetch_add(1, std::memory_order_release);
+            }
+
+            void remove(Key key) {
+                std::atomic<uint64_t>& epoch = stripeOf(key);
+                epoch.fetch_add(1, std::memory_order_acq_rel);
+                _backing.remove(key);
+                epoch.fetch_add(1, std::memory_order_release);
+            }
+
+            // Drops every thread's L1 copies, e.g. after writing to the backing
+            // cache directly.
+            void invalidateAll() {
+                for (auto& stripe : _epochs) stripe.value.fetch_add(2, std::memory_order_release);
+            }
+
+            Backing& backing() { return _backing; }
+        private:
+            struct Slot {
+                Key key{};
+                Value value{};
+                uint64_t epoch = 0;
+                std::chrono::steady_clock::time_point stamp;
+                bool valid = false;
+            };
+
+            struct alignas(64) Stripe {
+                std::atomic<uint64_t> value{0};
+            };
+
+            Backing& _backing;
+            size_t _slotMask;
+            size_t _stripeMask;
+            std::chrono::steady_clock::duration _maxStaleness;
+            std::vector<Stripe> _epochs;
+            uint64_t _id;
+
+            // Owns every thread's table for this instance, so they are freed
+            // with it; threads only keep weak references.
+            std::mutex _tablesMutex;
+            std::vector<std::shared_ptr<std::vector<Slot>>> _tables;
+
+            static size_t roundUp(size_t n) {
+                size_t size = 1;
+                while (size < n) size <<= 1;
+                return size;
+            }
+
+            // Ids are never reused, so a table left behind by a destroyed
+            // instance can never be picked up by a new one.
+            static uint64_t nextId() {
+                static std::atomic<uint64_t> counter{0};
+                return ++counter;
+            }
+
+            std::atomic<uint64_t>& stripeOf(const Key& key) {
+                return _epochs[CacheHash<Key>()(key) & _stripeMask].value;
+            }
+
+            bool fresh(const Slot& slot) const {
+                return _maxStaleness.count() == 0 ||
+                    std::chrono::steady_clock::now() - slot.stamp < _maxStaleness;
+            }
+
+            // The last table used is remembered so the common case is a single
+            // comparison. A thread's map holds weak references by instance id;
+            // entries of destroyed instances are dropped when a table is added.
+            std::vector<Slot>& localTable() {
+                thread_local uint64_t lastId = 0;
+                thread_local std::vector<Slot>* lastTable = nullptr;
+                thread_local std::unordered_map<uint64_t, std::weak_ptr<std::vector<Slot>>> tables;
+
+                if (lastId == _id) return *lastTable;
+
+                std::shared_ptr<std::vector<Slot>> table = tables[_id].lock();
+                if (!table) {
+                    for (auto it = tables.begin(); it != tables.end();) {
+                        if (it->second.expired() && it->first != _id) it = tables.erase(it);
+                        else ++it;
+                    }
+                    // Not make_shared: the slots must go when the instance does,
+                    // not when the last weak reference does.
+                    table.reset(new std::vector<Slot>(_slotMask + 1));
+                    tables[_id] = table;
+
+                    std::lock_guard<std::mutex> lock(_tablesMutex);
+                    _tables.push_back(table);
+                }
+                lastId = _id;
+                lastTable = table.get();
+                return *table;
+            }
+    };
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+namespace CacheSpace {
+    // Per-thread list of objects whose destruction has been deferred. Code
+    // running under a cache lock moves dying objects here instead of letting
+    // them be destroyed in place; the enclosing RetireScope frees them. With
+    // no scope open on the thread nothing would ever free the list, so the
+    // item is destroyed right away instead.
+    template<typename T>
+    class RetireList {
+        public:
+            static void retire(T&& item) {
+                if (depth() == 0) {
+                    T dying(std::move(item));
+                    return;
+                }
+                items().push_back(std::move(item));
+            }
+
+            static std::vector<T>& items() {
+                thread_local std::vector<T> list;
+                return list;
+            }
+
+            // Number of RetireScopes open on this thread.
+            static size_t& depth() {
+                thread_local size_t scopes = 0;
+                return scopes;
+            }
+    };
+
+    // Declared before a lock guard, so it is destroyed after the lock has been
+    // released; it frees whatever was retired on this thread since it was
+    // created. Scopes nest, each only owning the items retired inside it.
+    template<typename T>
+    class RetireScope {
+        public:
+            RetireScope(): _mark(RetireList<T>::items().size()) {
+                RetireList<T>::depth()++;
+            }
+
+            ~RetireScope() {
+                RetireList<T>::depth()--;
+                std::vector<T>& items = RetireList<T>::items();
+                items.erase(items.begin() + _mark, items.end());
+            }
+
+            RetireScope(const RetireScope&) = delete;
+            RetireScope& operator=(const RetireScope&) = delete;
+
+            // Moves this scope's items off the shared list.
+            std::vector<T> take() {
+                std::vector<T>& items = RetireList<T>::items();
+                std::vector<T> taken(std::make_move_iterator(items.begin() + _mark),
+                                     std::make_move_iterator(items.end()));
+                items.erase(items.begin() + _mark, items.end());
+                return taken;
+            }
+
+            size_t size() const { return RetireList<T>::items().size() - _mark; }
+
+            bool empty() const { return size() == 0; }
+        private:
+            size_t _mark;
+    };
+
+    // Moves evicted entries and replaced values out of a cache's critical
+    // section. Evicted entries are handed, in one batch per operation, to an
+    // optional listener that runs after the lock is dropped; both they and the
+    // replaced values are destroyed only then.
+    template<typename Key, typename Value>
+    class EvictionBatch {
+        public:
+            using entry_type = std::pair<Key, Value>;
+            using listener_type = std::function<void(const entry_type* entries, size_t count)>;
+
+            class Scope {
+                public:
+                    explicit Scope(EvictionBatch& batch): _batch(batch) {}
+
+                    // The listener may use a cache on this thread itself, so the
+                    // batch is taken off the per-thread list before the call.
+                    ~Scope() {
+                        if (_evicted.empty() || !_batch._active.load(std::memory_order_acquire)) return;
+                        std::vector<entry_type> entries = _evicted.take();
+                        _batch.notify(entries.data(), entries.size());
+                    }
+                private:
+                    EvictionBatch& _batch;
+                    RetireScope<entry_type> _evicted;
+                    RetireScope<Value> _released;
+            };
+
+            EvictionBatch(): _active(false) {}
+
+            void setListener(listener_type listener) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _listener = listener ? std::make_shared<const listener_type>(std::move(listener)) : nullptr;
+                _active.store(_listener != nullptr, std::memory_order_release);
+            }
+
+            // Called under the cache lock; takes the entry's key and value.
+            void evicted(Key& key, Value& value) {
+                if (trivial() && !_active.load(std::memory_order_relaxed)) return;
+                RetireList<entry_type>::retire(entry_type(std::move(key), std::move(value)));
+            }
+
+            // Called under the cache lock before a value is overwritten or its
+            // entry removed.
+            static void released(Value& value) {
+                if constexpr (!std::is_trivially_destructible<Value>::value) {
+                    RetireList<Value>::retire(std::move(value));
+                }
+            }
+        private:
+            std::mutex _mutex;
+            std::shared_ptr<const listener_type> _listener;
+            std::atomic<bool> _active;
+
+            static constexpr bool trivial() {
+                return std::is_trivially_destructible<Key>::value && std::is_trivially_destructible<Value>::value;
+            }
+
+            void notify(const entry_type* entries, size_t count) {
+                std::shared_ptr<const listener_type> listener;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    listener = _listener;
+                }
+                if (listener) (*listener)(entries, count);
+            }
+    };
+}
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // S3-FIFO (Yang et al., SOSP'23): a small probationary FIFO S (~10% of the
+    // capacity), a main FIFO M and a ghost FIFO G of key fingerprints. New keys
+    // enter S unless G remembers them; S evicts into M only entries that were
+    // hit again, and M reinserts entries with a non-zero counter.
+    //
+    // Queues are only pushed and popped, so a hit just bumps a 2-bit saturating
+    // counter: get() runs under a shared lock and never relinks anything.
+    template<typename Key, typename Value>
+    class S3FIFO_Cache : public CachePolicy<Key, Value> {
+        public:
+            S3FIFO_Cache(int capacity, double smallRatio = 0.1):
+                _smallRatio(smallRatio),
+                _ticket(0),
+                _smallSize(0),
+                _mainSize(0),
+                _smallStale(0),
+                _mainStale(0) {
+                    applyCapacity(static_cast<size_t>(std::max(capacity, 0)));
+                }
+            ~S3FIFO_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return false;
+
+                touch(it->second);
+                value = it->second.value;
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+
+                trimLocked(RESIZE_STEP);
+                if (_capacity == 0) return;
+                auto it = _entries.find(key);
+                if (it != _entries.end()) {
+                    it->second.value = value;
+                    touch(it->second);
+                    return;
+                }
+
+                if (_smallSize + _mainSize >= _capacity) evictOne();
+
+                bool remembered = takeGhost(fingerprint(key));
+                Entry& entry = _entries.emplace(std::piecewise_construct,
+                    std::forward_as_tuple(key), std::forward_as_tuple(value)).first->second;
+                enqueue(key, entry, remembered ? Queue::Main : Queue::Small);
+            }
+
+            void remove(Key key) {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return;
+
+                Queue queue = it->second.queue;
+                if (queue == Queue::Small) {
+                    _smallSize--;
+                    _smallStale++;
+                } else {
+                    _mainSize--;
+                    _mainStale++;
+                }
+                _entries.erase(it);
+                if (queue == Queue::Small && _smallStale > _smallSize + RESIZE_STEP) compact(_small, _smallStale);
+                if (queue == Queue::Main && _mainStale > _mainSize + RESIZE_STEP) compact(_main, _mainStale);
+            }
+
+            // The S and G bounds follow the new capacity. get() only holds the
+            // shared lock, so a shrink drains on put(): up to RESIZE_STEP
+            // surplus entries (or ghosts) per call, or through trim().
+            void setCapacity(size_t capacity) {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                applyCapacity(capacity);
+            }
+
+            // Returns how many entries are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                size_t resident = _smallSize + _mainSize;
+                return resident > _capacity ? resident - _capacity : 0;
+            }
+
+            size_t capacity() {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                return _capacity;
+            }
+
+            size_t size() {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                return _smallSize + _mainSize;
+            }
+        private:
+            enum class Queue : unsigned char { Small, Main };
+
+            static constexpr uint8_t MAX_FREQ = 3;
+
+            struct Entry {
+                Value value;
+                std::atomic<uint8_t> freq;
+                Queue queue;
+                uint64_t ticket;
+
+                explicit Entry(const Value& v): value(v), freq(0), queue(Queue::Small), ticket(0) {}
+            };
+
+            // Queue slots carry the ticket of the enqueue that created them, so
+            // slots left behind by remove() are skipped on pop. remove() counts
+            // them, and a queue is compacted once they outnumber its live slots,
+            // so put/remove churn without evictions cannot grow it unbounded.
+            struct Slot {
+                Key key;
+                uint64_t ticket;
+            };
+
+            double _smallRatio;
+            size_t _capacity;
+            size_t _smallCapacity;
+            size_t _ghostCapacity;
+            uint64_t _ticket;
+            size_t _smallSize;
+            size_t _mainSize;
+            size_t _smallStale;
+            size_t _mainStale;
+
+            std::shared_mutex _mutex;
+            std::unordered_map<Key, Entry> _entries;
+
+            std::deque<Slot> _small;
+            std::deque<Slot> _main;
+            std::deque<uint64_t> _ghost;
+            std::unordered_map<uint64_t, uint32_t> _ghostIndex;
+
+            static void touch(Entry& entry) {
+                uint8_t freq = entry.freq.load(std::memory_order_relaxed);
+                while (freq < MAX_FREQ &&
+                    !entry.freq.compare_exchange_weak(freq, freq + 1, std::memory_order_relaxed)) {}
+            }
+
+            static uint64_t fingerprint(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+
+            void enqueue(const Key& key, Entry& entry, Queue queue) {
+                entry.queue = queue;
+                entry.ticket = ++_ticket;
+
+                if (queue == Queue::Small) {
+                    _small.push_back(Slot{key, entry.ticket});
+                    _smallSize++;
+                } else {
+                    _main.push_back(Slot{key, entry.ticket});
+                    _mainSize++;
+                }
+            }
+
+            void applyCapacity(size_t capacity) {
+                _capacity = capacity;
+                _smallCapacity = std::max<size_t>(1, static_cast<size_t>(_capacity * _smallRatio));
+                _ghostCapacity = std::max<size_t>(1, _capacity - std::min(_capacity, _smallCapacity));
+            }
+
+            void evict() {
+                if (_smallSize >= _smallCapacity || _mainSize == 0) evictSmall();
+                else evictMain();
+            }
+
+            // An evict() from S may only promote its victim to M, so keep
+            // going until an entry has actually left.
+            void evictOne() {
+                size_t resident = _smallSize + _mainSize;
+                while (resident > 0 && _smallSize + _mainSize == resident) evict();
+            }
+
+            void trimLocked(size_t maxEntries) {
+                for (; maxEntries > 0; maxEntries--) {
+                    if (_smallSize + _mainSize > _capacity) evictOne();
+                    else if (_ghost.size() > _ghostCapacity) popGhost();
+                    else return;
+                }
+            }
+
+            // Pops one live entry from S: if it was hit while probationary it
+            // moves to M, otherwise only its fingerprint is kept in G.
+            void evictSmall() {
+                while (!_small.empty()) {
+                    Slot slot = _small.front();
+                    _small.pop_front();
+
+                    auto it = _entries.find(slot.key);
+                    if (it == _entries.end() || it->second.ticket != slot.ticket) {
+                        if (_smallStale > 0) _smallStale--;
+                        continue;
+                    }
+
+                    Entry& entry = it->second;
+                    _smallSize--;
+                    if (entry.freq.load(std::memory_order_relaxed) > 0) {
+                        entry.freq.store(0, std::memory_order_relaxed);
+                        enqueue(slot.key, entry, Queue::Main);
+                    } else {
+                        addGhost(fingerprint(slot.key));
+                        _entries.erase(it);
+                    }
+                    return;
+                }
+            }
+
+            // Pops from M until an entry with a zero counter is found; the ones
+            // passed over are reinserted with their counter decremented.
+            void evictMain() {
+                while (!_main.empty()) {
+                    Slot slot = _main.front();
+                    _main.pop_front();
+
+                    auto it = _entries.find(slot.key);
+                    if (it == _entries.end() || it->second.ticket != slot.ticket) {
+                        if (_mainStale > 0) _mainStale--;
+                        continue;
+                    }
+
+                    Entry& entry = it->second;
+                    uint8_t freq = entry.freq.load(std::memory_order_relaxed);
+                    if (freq > 0) {
+                        entry.freq.store(freq - 1, std::memory_order_relaxed);
+                        entry.ticket = ++_ticket;
+                        _main.push_back(Slot{slot.key, entry.ticket});
+                        continue;
+                    }
+
+                    _mainSize--;
+                    _entries.erase(it);
+                    return;
+                }
+            }
+
+            bool live(const Slot& slot) const {
+                auto it = _entries.find(slot.key);
+                return it != _entries.end() && it->second.ticket == slot.ticket;
+            }
+
+            void compact(std::deque<Slot>& queue, size_t& stale) {
+                std::deque<Slot> kept;
+                for (const Slot& slot : queue) {
+                    if (live(slot)) kept.push_back(slot);
+                }
+                queue.swap(kept);
+                stale = 0;
+            }
+
+            // Each push puts G at most one over its bound; a surplus left by
+            // setCapacity() is popped by trimLocked().
+            void addGhost(uint64_t fp) {
+                _ghost.push_back(fp);
+                _ghostIndex[fp]++;
+                if (_ghost.size() > _ghostCapacity) popGhost();
+            }
+
+            void popGhost() {
+                auto it = _ghostIndex.find(_ghost.front());
+                if (it != _ghostIndex.end() && --it->second == 0) _ghostIndex.erase(it);
+                _ghost.pop_front();
+            }
+
+            bool takeGhost(uint64_t fp) {
+                auto it = _ghostIndex.find(fp);
+                if (it == _ghostIndex.end()) return false;
+
+                if (--it->second == 0) _ghostIndex.erase(it);
+                return true;
+            }
+    };
+
+    template<typename Key, typename Value>
+    class Hash_S3FIFO_Cache : public CachePolicy<Key, Value> {
+        public:
+            Hash_S3FIFO_Cache(size_t capacity, int sliceNum, double smallRatio = 0.1):
+                _capacity(capacity),
+                _sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) {
+                    size_t size = std::ceil(_capacity / static_cast<double>(_sliceNum));
+
+                    for (size_t i = 0; i < _sliceNum; i++) {
+                        _slicedCache.emplace_back(new S3FIFO_Cache<Key, Value>(size, smallRatio));
+                    }
+                }
+
+            Value get(Key key) {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) {
+                size_t index = Hash(key) % _sliceNum;
+                return _slicedCache[index]->get(key, value);
+            }
+
+            void put(Key key, Value value) {
+                size_t index = Hash(key) % _sliceNum;
+                _slicedCache[index]->put(key, value);
+            }
+
+            void remove(Key key) {
+                size_t index = Hash(key) % _sliceNum;
+                _slicedCache[index]->remove(key);
+            }
+
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+        private:
+            size_t _capacity;
+            size_t _sliceNum;
+            std::vector<std::unique_ptr<S3FIFO_Cache<Key, Value>>> _slicedCache;
+
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+    };
+}
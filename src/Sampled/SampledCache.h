@@ -0,0 +1,401 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <shared_mutex>
+
+namespace CacheSpace {
+    enum class SampledMode { LRU, LFU };
+
+    struct SampledOptions {
+        SampledMode mode = SampledMode::LRU;
+        size_t samples = 5;             // entries sampled per eviction
+        size_t poolSize = 16;           // best candidates kept between evictions
+        uint32_t logFactor = 10;        // LFU: higher values make the counter saturate later
+        uint64_t decayTicks = 0;        // LFU: clock ticks per counter decrement; 0 means the capacity
+    };
+
+    // Approximate LRU / LFU the way Redis does it. Entries sit in one flat
+    // array indexed by an open-addressing table of 32-bit slot numbers, and
+    // each carries a single 32-bit word of metadata:
+    //   - LRU: a 24-bit coarse timestamp;
+    //   - LFU: a 16-bit "last decrement" time and an 8-bit logarithmic
+    //     (Morris) counter. It is incremented with probability
+    //     1 / ((counter - 5) * logFactor + 1), and loses one for each
+    //     `decayTicks` the entry went without a hit.
+    // The clock is logical: it advances once per insertion, so recency is
+    // measured in misses rather than wall time.
+    //
+    // A hit is a single relaxed store to that word under a shared lock. To
+    // evict, `samples` random entries are scored (idle time, or 255 minus
+    // the decayed counter) and merged into a small pool of the best
+    // candidates seen so far; the best one still valid is evicted. That costs
+    // about 4 bytes of metadata plus 5-8 bytes of index per entry, where the
+    // list-based policies pay for two pointers, a shared_ptr control block
+    // and a hash-map node.
+    template<typename Key, typename Value>
+    class Sampled_Cache : public CachePolicy<Key, Value> {
+        public:
+            explicit Sampled_Cache(size_t capacity, const SampledOptions& options = SampledOptions()):
+                _options(options),
+                _capacity(capacity),
+                _mask(0),
+                _clock(0),
+                _random(0x9E3779B97F4A7C15ull) {
+                    if (capacity >= NIL / 2) throw std::length_error("Sampled_Cache: capacity too large");
+                    _options.samples = std::max<size_t>(_options.samples, 1);
+                    _options.poolSize = std::max<size_t>(_options.poolSize, 1);
+                    _pool.reserve(_options.poolSize);
+                    rehash(16);
+                }
+            ~Sampled_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+
+                size_t pos = findBucket(key);
+                if (pos == NPOS) return false;
+
+                Entry& entry = _entries[_table[pos]];
+                touch(entry);
+                value = entry.value;
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+
+                trimLocked(RESIZE_STEP);
+                size_t pos = findBucket(key);
+                if (_capacity == 0) {
+                    // An old value may still be draining; it must not outlive the write.
+                    if (pos != NPOS) eraseAt(pos);
+                    return;
+                }
+                if (pos != NPOS) {
+                    Entry& entry = _entries[_table[pos]];
+                    entry.value = value;
+                    touch(entry);
+                    return;
+                }
+
+                if (_entries.size() >= _capacity) evictOne();
+                _clock.store(_clock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+                _entries.emplace_back(key, value, initialMeta());
+                if ((_entries.size() + 1) * 4 > _table.size() * 3) rehash(_table.size() * 2);
+                else insertBucket(key, static_cast<uint32_t>(_entries.size() - 1));
+            }
+
+            void remove(Key key) {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+
+                size_t pos = findBucket(key);
+                if (pos != NPOS) eraseAt(pos);
+            }
+
+            // Shrinks drain on put() or trim(), RESIZE_STEP entries at a time.
+            void setCapacity(size_t capacity) {
+                if (capacity >= NIL / 2) throw std::length_error("Sampled_Cache: capacity too large");
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                _capacity = capacity;
+            }
+
+            // Returns how many entries are still over capacity.
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                trimLocked(maxEntries);
+                return _entries.size() > _capacity ? _entries.size() - _capacity : 0;
+            }
+
+            size_t capacity() {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                return _capacity;
+            }
+
+            size_t size() {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                return _entries.size();
+            }
+
+            // Bytes spent on top of the keys and values: the metadata words and
+            // the index table.
+            size_t metadataBytes() {
+                std::shared_lock<std::shared_mutex> lock(_mutex);
+                return _entries.size() * sizeof(uint32_t) + _table.size() * sizeof(uint32_t);
+            }
+        private:
+            static constexpr uint32_t NIL = UINT32_MAX;
+            static constexpr size_t NPOS = SIZE_MAX;
+            static constexpr uint32_t CLOCK_MASK = (1u << 24) - 1;
+            static constexpr uint32_t LFU_INIT = 5;     // new keys start above the bottom so they survive a few evictions
+
+            struct Entry {
+                Key key;
+                Value value;
+                std::atomic<uint32_t> meta;
+
+                Entry(const Key& k, const Value& v, uint32_t m): key(k), value(v), meta(m) {}
+                Entry(Entry&& other):
+                    key(std::move(other.key)),
+                    value(std::move(other.value)),
+                    meta(other.meta.load(std::memory_order_relaxed)) {}
+                Entry& operator=(Entry&& other) {
+                    key = std::move(other.key);
+                    value = std::move(other.value);
+                    meta.store(other.meta.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    return *this;
+                }
+            };
+
+            struct Candidate {
+                Key key;
+                uint32_t score;
+            };
+
+            SampledOptions _options;
+            size_t _capacity;
+            size_t _mask;
+            std::atomic<uint64_t> _clock;
+            uint64_t _random;
+
+            std::shared_mutex _mutex;
+            std::vector<Entry> _entries;
+            std::vector<uint32_t> _table;
+            std::vector<Candidate> _pool;       // ascending by score
+
+            uint64_t decayTicks() const {
+                return _options.decayTicks ? _options.decayTicks : std::max<uint64_t>(_capacity, 1);
+            }
+
+            uint32_t initialMeta() const {
+                uint64_t now = _clock.load(std::memory_order_relaxed);
+                if (_options.mode == SampledMode::LRU) return static_cast<uint32_t>(now) & CLOCK_MASK;
+                return (static_cast<uint32_t>(now / decayTicks()) & 0xFFFF) << 8 | LFU_INIT;
+            }
+
+            // Counter after the decrements owed since its last update.
+            uint32_t decayedCounter(uint32_t meta, uint64_t now) const {
+                uint32_t periods = (static_cast<uint32_t>(now / decayTicks()) - (meta >> 8)) & 0xFFFF;
+                uint32_t counter = meta & 0xFF;
+                return periods >= counter ? 0 : counter - periods;
+            }
+
+            // Concurrent hits on one key may overwrite each other's update,
+            // which only costs an increment of an approximate counter.
+            void touch(Entry& entry) {
+                uint64_t now = _clock.load(std::memory_order_relaxed);
+                if (_options.mode == SampledMode::LRU) {
+                    entry.meta.store(static_cast<uint32_t>(now) & CLOCK_MASK, std::memory_order_relaxed);
+                    return;
+                }
+
+                uint32_t counter = decayedCounter(entry.meta.load(std::memory_order_relaxed), now);
+                if (counter < 255) {
+                    uint32_t base = counter > LFU_INIT ? counter - LFU_INIT : 0;
+                    double p = 1.0 / (base * _options.logFactor + 1);
+                    if (threadRandom() < p) counter++;
+                }
+                entry.meta.store((static_cast<uint32_t>(now / decayTicks()) & 0xFFFF) << 8 | counter,
+                    std::memory_order_relaxed);
+            }
+
+            // Higher is evicted first.
+            uint32_t score(const Entry& entry) const {
+                uint64_t now = _clock.load(std::memory_order_relaxed);
+                uint32_t meta = entry.meta.load(std::memory_order_relaxed);
+                if (_options.mode == SampledMode::LRU) return (static_cast<uint32_t>(now) - meta) & CLOCK_MASK;
+                return 255 - decayedCounter(meta, now);
+            }
+
+            static double threadRandom() {
+                thread_local uint64_t state = CacheHash<std::thread::id>()(std::this_thread::get_id()) | 1;
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return (state >> 11) * (1.0 / 9007199254740992.0);
+            }
+
+            size_t nextSample() {
+                uint64_t z = (_random += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                z ^= z >> 31;
+                return static_cast<size_t>(z % _entries.size());
+            }
+
+            void trimLocked(size_t maxEntries) {
+                for (; maxEntries > 0 && _entries.size() > _capacity; maxEntries--) evictOne();
+            }
+
+            // Merges `samples` random entries into the pool and evicts its best
+            // candidate. Candidates that were removed, or hit since they were
+            // scored, are dropped on the way.
+            void evictOne() {
+                while (!_entries.empty()) {
+                    for (size_t i = 0; i < _options.samples; i++) offer(_entries[nextSample()]);
+
+                    while (!_pool.empty()) {
+                        Candidate candidate = std::move(_pool.back());
+                        _pool.pop_back();
+
+                        size_t pos = findBucket(candidate.key);
+                        if (pos == NPOS || score(_entries[_table[pos]]) < candidate.score) continue;
+                        eraseAt(pos);
+                        return;
+                    }
+                }
+            }
+
+            void offer(const Entry& entry) {
+                uint32_t value = score(entry);
+                for (auto it = _pool.begin(); it != _pool.end(); ++it) {
+                    if (it->key == entry.key) {
+                        _pool.erase(it);
+                        break;
+                    }
+                }
+                if (_pool.size() == _options.poolSize) {
+                    if (value <= _pool.front().score) return;
+                    _pool.erase(_pool.begin());
+                }
+                auto at = std::upper_bound(_pool.begin(), _pool.end(), value,
+                    [](uint32_t v, const Candidate& c) { return v < c.score; });
+                _pool.insert(at, Candidate{entry.key, value});
+            }
+
+            size_t findBucket(const Key& key) const {
+                size_t pos = CacheHash<Key>()(key) & _mask;
+                while (_table[pos] != NIL) {
+                    if (_entries[_table[pos]].key == key) return pos;
+                    pos = (pos + 1) & _mask;
+                }
+                return NPOS;
+            }
+
+            void insertBucket(const Key& key, uint32_t index) {
+                size_t pos = CacheHash<Key>()(key) & _mask;
+                while (_table[pos] != NIL) pos = (pos + 1) & _mask;
+                _table[pos] = index;
+            }
+
+            void rehash(size_t buckets) {
+                _table.assign(buckets, NIL);
+                _mask = buckets - 1;
+                for (size_t i = 0; i < _entries.size(); i++) insertBucket(_entries[i].key, static_cast<uint32_t>(i));
+            }
+
+            // Removes the entry indexed at `pos`; the last entry moves into its
+            // slot so the array stays dense for sampling.
+            void eraseAt(size_t pos) {
+                uint32_t index = _table[pos];
+                eraseBucket(pos);
+
+                uint32_t last = static_cast<uint32_t>(_entries.size() - 1);
+                if (index != last) {
+                    size_t moved = CacheHash<Key>()(_entries[last].key) & _mask;
+                    while (_table[moved] != last) moved = (moved + 1) & _mask;
+                    _table[moved] = index;
+                    _entries[index] = std::move(_entries[last]);
+                }
+                _entries.pop_back();
+            }
+
+            // Backward-shift deletion, as in FlatLRUCore.
+            void eraseBucket(size_t pos) {
+                size_t next = (pos + 1) & _mask;
+                while (_table[next] != NIL) {
+                    size_t home = CacheHash<Key>()(_entries[_table[next]].key) & _mask;
+                    if (((next - home) & _mask) >= ((next - pos) & _mask)) {
+                        _table[pos] = _table[next];
+                        pos = next;
+                    }
+                    next = (next + 1) & _mask;
+                }
+                _table[pos] = NIL;
+            }
+    };
+
+    template<typename Key, typename Value>
+    class Hash_Sampled_Cache : public CachePolicy<Key, Value> {
+        public:
+            Hash_Sampled_Cache(size_t capacity, int sliceNum, const SampledOptions& options = SampledOptions()):
+                _sliceNum(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) {
+                    size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+
+                    for (size_t i = 0; i < _sliceNum; i++) {
+                        _slicedCache.emplace_back(new Sampled_Cache<Key, Value>(size, options));
+                    }
+                }
+
+            Value get(Key key) {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) {
+                return _slicedCache[Hash(key) % _sliceNum]->get(key, value);
+            }
+
+            void put(Key key, Value value) {
+                _slicedCache[Hash(key) % _sliceNum]->put(key, value);
+            }
+
+            void remove(Key key) {
+                _slicedCache[Hash(key) % _sliceNum]->remove(key);
+            }
+
+            void setCapacity(size_t capacity) {
+                size_t size = std::ceil(capacity / static_cast<double>(_sliceNum));
+                for (auto& cache : _slicedCache) cache->setCapacity(size);
+            }
+
+            size_t trim(size_t maxEntries = RESIZE_STEP) {
+                size_t surplus = 0;
+                for (auto& cache : _slicedCache) surplus += cache->trim(maxEntries);
+                return surplus;
+            }
+
+            size_t capacity() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->capacity();
+                return total;
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->size();
+                return total;
+            }
+
+            size_t metadataBytes() {
+                size_t total = 0;
+                for (auto& cache : _slicedCache) total += cache->metadataBytes();
+                return total;
+            }
+        private:
+            size_t _sliceNum;
+            std::vector<std::unique_ptr<Sampled_Cache<Key, Value>>> _slicedCache;
+
+            size_t Hash(const Key& key) {
+                return CacheHash<Key>()(key);
+            }
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace CacheSpace {
+    struct ScanOptions {
+        size_t probationCapacity = 8;   // entries admitted during scans
+        uint32_t minRunLength = 8;      // consecutive keys that make a scan
+        uint32_t missWindow = 64;       // recent gets watched for bursts
+        double burstMissRatio = 0.9;    // miss share that counts as a burst
+    };
+
+    // Classifies accesses as scan traffic. Integral keys are followed by a
+    // small table of streams, each remembering its last key and run length;
+    // an access extending a stream by +1 or -1 lengthens its run, so several
+    // interleaved scans are tracked at once. Independently, a window of recent
+    // get outcomes flags a miss burst, which catches scans over keys with no
+    // numeric order.
+    //
+    // Not synchronized: callers hold their own lock.
+    template<typename Key>
+    class ScanDetector {
+        public:
+            static constexpr size_t STREAMS = 8;
+
+            explicit ScanDetector(const ScanOptions& options):
+                _options(options),
+                _clock(0),
+                _window(0),
+                _windowFill(0),
+                _misses(0) {
+                    if (_options.missWindow == 0 || _options.missWindow > 64) _options.missWindow = 64;
+                }
+
+            // Feeds one access; returns true if it is part of a scan.
+            bool observe(const Key& key) {
+                return sequential(key) || burst();
+            }
+
+            void recordGet(bool hit) {
+                uint64_t top = uint64_t(1) << (_options.missWindow - 1);
+                if (_windowFill == _options.missWindow) {
+                    if (_window & 1) _misses--;
+                } else {
+                    _windowFill++;
+                }
+                _window = (_window >> 1) | (hit ? 0 : top);
+                if (!hit) _misses++;
+            }
+
+            bool burst() const {
+                return _windowFill == _options.missWindow &&
+                    _misses >= _options.burstMissRatio * _options.missWindow;
+            }
+        private:
+            struct Stream {
+                int64_t last = 0;
+                uint32_t run = 0;
+                uint64_t stamp = 0;
+            };
+
+            ScanOptions _options;
+            std::array<Stream, STREAMS> _streams;
+            uint64_t _clock;
+
+            // One bit per recent get, set for a miss; the oldest is the low bit.
+            uint64_t _window;
+            uint32_t _windowFill;
+            uint32_t _misses;
+
+            bool sequential(const Key& key) {
+                if constexpr (std::is_integral<Key>::value) {
+                    int64_t k = static_cast<int64_t>(key);
+                    Stream* victim = &_streams[0];
+                    for (auto& stream : _streams) {
+                        if (stream.run > 0 && k == stream.last) {
+                            stream.stamp = ++_clock;
+                            return stream.run >= _options.minRunLength;
+                        }
+                        if (stream.run > 0 && (k == stream.last + 1 || k == stream.last - 1)) {
+                            stream.last = k;
+                            stream.run++;
+                            stream.stamp = ++_clock;
+                            return stream.run >= _options.minRunLength;
+                        }
+                        if (stream.stamp < victim->stamp) victim = &stream;
+                    }
+
+                    *victim = Stream{k, 1, ++_clock};
+                    return false;
+                } else {
+                    (void)key;
+                    return false;
+                }
+            }
+    };
+}
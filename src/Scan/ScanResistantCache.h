@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ScanDetector.h"
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+#include "../LRU/LRUCache.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace CacheSpace {
+    // Keeps scans out of the main cache. Writes classified as scan traffic by
+    // the ScanDetector go to a small probation LRU instead of MainCache; a
+    // later hit in probation proves the key is reused and promotes it. The
+    // main cache's hot set therefore survives a batch job walking through
+    // more keys than the cache holds.
+    //
+    // Until the main cache has filled up once, a write displaces nothing, so
+    // every write goes to it: a cold cache misses on nearly every get, which
+    // the detector cannot tell apart from a scan.
+    //
+    // A promotion, put() and remove() of one key are serialized by a striped
+    // mutex, so a promotion never writes back a value a put() has replaced
+    // and a key is never left in both tiers. Lock order is stripe -> main /
+    // probation -> detector.
+    //
+    // MainCache needs get/put/remove and size/capacity (LRU_Cache,
+    // Hash_LRU_Cache, ARC_Cache).
+    // Total capacity is the main cache's plus `probationCapacity`.
+    template<typename Key, typename Value, typename MainCache = LRU_Cache<Key, Value>>
+    class ScanResistant_Cache : public CachePolicy<Key, Value> {
+        public:
+            template<typename... Args>
+            explicit ScanResistant_Cache(const ScanOptions& options, Args&&... mainArgs):
+                _main(std::make_unique<MainCache>(std::forward<Args>(mainArgs)...)),
+                _probation(std::make_unique<LRU_Cache<Key, Value>>(static_cast<int>(options.probationCapacity))),
+                _detector(options),
+                _filled(false),
+                _scanWrites(0),
+                _promotions(0) {}
+            ~ScanResistant_Cache() override = default;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                bool hit = _main->get(key, value);
+                if (!hit) {
+                    std::lock_guard<std::mutex> lock(stripe(key));
+                    hit = _main->get(key, value);
+                    if (!hit && _probation->get(key, value)) {
+                        _probation->remove(key);
+                        _main->put(key, value);
+                        _promotions++;
+                        hit = true;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                _detector.observe(key);
+                _detector.recordGet(hit);
+                return hit;
+            }
+
+            // A scan write replaces any main-cache copy, so the value read
+            // back always comes from exactly one place.
+            void put(Key key, Value value) override {
+                bool scan;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    scan = _detector.observe(key);
+                }
+                scan = scan && mainFilled();
+
+                std::lock_guard<std::mutex> lock(stripe(key));
+                if (scan) {
+                    _main->remove(key);
+                    _probation->put(key, value);
+                    _scanWrites++;
+                } else {
+                    _probation->remove(key);
+                    _main->put(key, value);
+                }
+            }
+
+            void remove(Key key) {
+                std::lock_guard<std::mutex> lock(stripe(key));
+                _main->remove(key);
+                _probation->remove(key);
+            }
+
+            size_t scanWrites() const { return _scanWrites.load(std::memory_order_relaxed); }
+
+            size_t promotions() const { return _promotions.load(std::memory_order_relaxed); }
+
+            MainCache& main() { return *_main; }
+        private:
+            static constexpr size_t STRIPES = 64;
+
+            std::unique_ptr<MainCache> _main;
+            std::unique_ptr<LRU_Cache<Key, Value>> _probation;
+
+            std::array<std::mutex, STRIPES> _stripes;
+
+            std::mutex _mutex;
+            ScanDetector<Key> _detector;
+
+            std::atomic<bool> _filled;
+            std::atomic<size_t> _scanWrites;
+            std::atomic<size_t> _promotions;
+
+            std::mutex& stripe(const Key& key) {
+                return _stripes[CacheHash<Key>()(key) % STRIPES];
+            }
+
+            // Latches once the main cache is full; only asked when the detector
+            // reports a scan, since size() of a sharded cache visits every shard.
+            bool mainFilled() {
+                if (_filled.load(std::memory_order_relaxed)) return true;
+                if (_main->size() < _main->capacity()) return false;
+                _filled.store(true, std::memory_order_relaxed);
+                return true;
+            }
+    };
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include "MemcacheProtocol.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace CacheSpace {
+    struct ServerOptions {
+        std::string host = "127.0.0.1";     // TCP listen address; empty disables TCP
+        uint16_t port = 11311;
+        std::string unixPath;               // Unix-domain socket path; empty disables it
+        size_t threads = 0;                 // event loops; 0 means one per core
+        size_t maxValueBytes = 1 << 20;
+        size_t maxOutputBytes = 4 << 20;    // stop reading a connection with more replies queued
+    };
+
+    // memcached text-protocol front end for any cache with get/put/remove
+    // over std::string keys and Memcache::Item pointers (Hash_LRU_Cache,
+    // Hash_LFU_Cache, ARC_Cache); remove must return whether the key was
+    // present, so a delete is one atomic step. Each thread runs its own
+    // epoll loop and accepts from the shared listening sockets
+    // (EPOLLEXCLUSIVE), so a connection stays on one thread for its lifetime.
+    //
+    // All requests already buffered on a connection are executed before
+    // anything is written, and the replies go out in one writev. Values are
+    // never copied into the output: a hit queues iovecs pointing into the
+    // shared Item, which stays alive until those bytes have been sent.
+    //
+    // A client that pipelines faster than it reads would otherwise grow its
+    // output queue without bound: once more than maxOutputBytes is queued
+    // the connection stops executing requests and drops EPOLLIN, and picks
+    // up again when the queue has drained to half of that.
+    template<typename Backing>
+    class Cache_Server {
+        public:
+            using item_ptr = std::shared_ptr<const Memcache::Item>;
+
+            Cache_Server(Backing& backing, const ServerOptions& options):
+                _backing(backing),
+                _options(options),
+                _tcpFd(-1),
+                _unixFd(-1),
+                _running(false) {
+                    if (_options.threads == 0) _options.threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+
+            ~Cache_Server() {
+                stop();
+                if (_tcpFd >= 0) ::close(_tcpFd);
+                if (_unixFd >= 0) {
+                    ::close(_unixFd);
+                    ::unlink(_options.unixPath.c_str());
+                }
+            }
+
+            Cache_Server(const Cache_Server&) = delete;
+            Cache_Server& operator=(const Cache_Server&) = delete;
+
+            // Opens the listening sockets and starts the event loops.
+            void start() {
+                if (!_options.host.empty()) _tcpFd = listenTcp();
+                if (!_options.unixPath.empty()) _unixFd = listenUnix();
+                if (_tcpFd < 0 && _unixFd < 0) throw std::runtime_error("Cache_Server: no listening socket configured");
+
+                _running = true;
+                for (size_t i = 0; i < _options.threads; i++) {
+                    _loops.emplace_back(new EventLoop(*this));
+                }
+                for (auto& loop : _loops) {
+                    EventLoop* raw = loop.get();
+                    _threads.emplace_back([raw]() { raw->run(); });
+                }
+            }
+
+            void stop() {
+                if (!_running.exchange(false)) return;
+                for (auto& loop : _loops) loop->wake();
+                for (auto& thread : _threads) thread.join();
+                _threads.clear();
+                _loops.clear();
+            }
+
+            uint16_t port() const {
+                sockaddr_in addr{};
+                socklen_t len = sizeof(addr);
+                if (_tcpFd < 0 || getsockname(_tcpFd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return 0;
+                return ntohs(addr.sin_port);
+            }
+        private:
+            static constexpr size_t READ_CHUNK = 64 << 10;
+            static constexpr int MAX_IOVECS = 1024;
+
+            // A slice of output; `owner` keeps a cache item alive until sent.
+            struct Segment {
+                const char* data;
+                size_t size;
+                item_ptr owner;
+            };
+
+            struct Connection {
+                int fd;
+                std::string input;
+                std::deque<Segment> output;
+                size_t outputBytes = 0;
+                bool reading = true;    // EPOLLIN registered
+                bool writing = false;   // EPOLLOUT registered
+                bool eof = false;       // peer is done sending
+                bool stalled = false;   // stopped serving over the output limit
+                bool closing = false;   // close once the output is flushed
+            };
+
+            class EventLoop {
+                public:
+                    explicit EventLoop(Cache_Server& server): _server(server) {
+                        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+                        _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                        if (_epollFd < 0 || _wakeFd < 0) throw std::runtime_error("Cache_Server: cannot create event loop");
+
+                        watch(_wakeFd, EPOLLIN);
+                        if (_server._tcpFd >= 0) watch(_server._tcpFd, EPOLLIN | EPOLLEXCLUSIVE);
+                        if (_server._unixFd >= 0) watch(_server._unixFd, EPOLLIN | EPOLLEXCLUSIVE);
+                    }
+
+                    ~EventLoop() {
+                        for (auto& pair : _connections) ::close(pair.first);
+                        ::close(_wakeFd);
+                        ::close(_epollFd);
+                    }
+
+                    void wake() {
+                        uint64_t one = 1;
+                        ssize_t ignored = ::write(_wakeFd, &one, sizeof(one));
+                        (void)ignored;
+                    }
+
+                    void run() {
+                        epoll_event events[256];
+                        Memcache::Request request;
+                        while (_server._running.load(std::memory_order_acquire)) {
+                            int n = epoll_wait(_epollFd, events, 256, -1);
+                            for (int i = 0; i < n; i++) {
+                                int fd = events[i].data.fd;
+                                if (fd == _wakeFd) continue;
+                                if (fd == _server._tcpFd || fd == _server._unixFd) {
+                                    acceptAll(fd);
+                                    continue;
+                                }
+
+                                auto it = _connections.find(fd);
+                                if (it == _connections.end()) continue;
+                                Connection& conn = *it->second;
+                                bool alive = true;
+                                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) alive = readAndServe(conn, request);
+                                if (alive && (events[i].events & EPOLLOUT)) {
+                                    alive = flush(conn);
+                                    if (alive && conn.stalled && conn.outputBytes <= _server._options.maxOutputBytes / 2) {
+                                        alive = readAndServe(conn, request);
+                                    }
+                                }
+                                if (!alive) close(fd);
+                            }
+                        }
+                    }
+                private:
+                    Cache_Server& _server;
+                    int _epollFd;
+                    int _wakeFd;
+                    std::unordered_map<int, std::unique_ptr<Connection>> _connections;
+
+                    void watch(int fd, uint32_t events) {
+                        epoll_event event{};
+                        event.events = events;
+                        event.data.fd = fd;
+                        epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+                    }
+
+                    void acceptAll(int listenFd) {
+                        while (true) {
+                            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                            if (fd < 0) return;
+                            if (listenFd == _server._tcpFd) {
+                                int one = 1;
+                                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                            }
+                            auto conn = std::make_unique<Connection>();
+                            conn->fd = fd;
+                            _connections[fd] = std::move(conn);
+                            watch(fd, EPOLLIN | EPOLLRDHUP);
+                        }
+                    }
+
+                    void close(int fd) {
+                        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                        ::close(fd);
+                        _connections.erase(fd);
+                    }
+
+                    // Drains the socket, runs every complete request, then writes.
+                    // Input left over from a stalled round is served first.
+                    bool readAndServe(Connection& conn, Memcache::Request& request) {
+                        while (true) {
+                            serve(conn, request);
+                            while (!conn.closing && !conn.eof && !backlogged(conn)) {
+                                size_t used = conn.input.size();
+                                conn.input.resize(used + READ_CHUNK);
+                                ssize_t n = ::read(conn.fd, &conn.input[used], READ_CHUNK);
+                                conn.input.resize(used + std::max<ssize_t>(n, 0));
+                                if (n > 0) {
+                                    serve(conn, request);
+                                    continue;
+                                }
+                                if (n == 0) conn.eof = true;
+                                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+                                break;
+                            }
+                            if (conn.eof && !backlogged(conn)) conn.closing = true;
+
+                            // If the socket took the whole backlog, no EPOLLOUT
+                            // will come to resume serving; go round again.
+                            conn.stalled = backlogged(conn);
+                            if (!flush(conn)) return false;
+                            if (!conn.stalled || conn.writing) return true;
+                        }
+                    }
+
+                    // Executes complete requests until the input runs out or
+                    // the output queue is over the high-water mark.
+                    void serve(Connection& conn, Memcache::Request& request) {
+                        size_t offset = 0;
+                        while (!conn.closing && !backlogged(conn) && offset < conn.input.size()) {
+                            size_t consumed = 0;
+                            const char* begin = conn.input.data() + offset;
+                            auto status = Memcache::parse(begin, conn.input.data() + conn.input.size(),
+                                                          _server._options.maxValueBytes, request, consumed);
+                            if (status == Memcache::ParseStatus::Incomplete) break;
+                            if (status == Memcache::ParseStatus::Fatal) {
+                                reply(conn, "CLIENT_ERROR bad data chunk\r\n");
+                                conn.closing = true;
+                                break;
+                            }
+                            _server.execute(request, conn);
+                            offset += consumed;
+                        }
+                        conn.input.erase(0, offset);
+                    }
+
+                    bool backlogged(const Connection& conn) const {
+                        return conn.outputBytes > _server._options.maxOutputBytes;
+                    }
+
+                    // Writes as much queued output as the socket takes; false
+                    // once the connection should be closed.
+                    bool flush(Connection& conn) {
+                        iovec iov[MAX_IOVECS];
+                        while (!conn.output.empty()) {
+                            int count = 0;
+                            for (auto it = conn.output.begin(); it != conn.output.end() && count < MAX_IOVECS; ++it, ++count) {
+                                iov[count].iov_base = const_cast<char*>(it->data);
+                                iov[count].iov_len = it->size;
+                            }
+
+                            ssize_t n = ::writev(conn.fd, iov, count);
+                            if (n < 0) {
+                                if (errno == EINTR) continue;
+                                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                                setInterest(conn, !conn.stalled, true);
+                                return true;
+                            }
+
+                            size_t written = static_cast<size_t>(n);
+                            conn.outputBytes -= written;
+                            while (written > 0) {
+                                Segment& front = conn.output.front();
+                                if (written < front.size) {
+                                    front.data += written;
+                                    front.size -= written;
+                                    break;
+                                }
+                                written -= front.size;
+                                conn.output.pop_front();
+                            }
+                        }
+                        setInterest(conn, true, false);
+                        return !conn.closing;
+                    }
+
+                    void setInterest(Connection& conn, bool reading, bool writing) {
+                        if (conn.reading == reading && conn.writing == writing) return;
+                        conn.reading = reading;
+                        conn.writing = writing;
+                        epoll_event event{};
+                        event.events = (reading ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0u) | (writing ? uint32_t(EPOLLOUT) : 0u);
+                        event.data.fd = conn.fd;
+                        epoll_ctl(_epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+                    }
+            };
+
+            Backing& _backing;
+            ServerOptions _options;
+            int _tcpFd;
+            int _unixFd;
+            std::atomic<bool> _running;
+            std::vector<std::unique_ptr<EventLoop>> _loops;
+            std::vector<std::thread> _threads;
+
+            static void reply(Connection& conn, const char* text) {
+                queue(conn, Segment{text, std::strlen(text), nullptr});
+            }
+
+            static void queue(Connection& conn, Segment segment) {
+                conn.outputBytes += segment.size;
+                conn.output.push_back(std::move(segment));
+            }
+
+            void execute(const Memcache::Request& request, Connection& conn) {
+                using Memcache::Command;
+                switch (request.command) {
+                    case Command::Get: {
+                        item_ptr item;
+                        for (std::string_view key : request.keys) {
+                            if (!_backing.get(std::string(key), item) || !item) continue;
+                            queue(conn, Segment{item->header.data(), item->header.size(), item});
+                            queue(conn, Segment{item->data.data(), item->data.size(), item});
+                        }
+                        reply(conn, "END\r\n");
+                        break;
+                    }
+                    case Command::Set: {
+                        std::string key(request.keys[0]);
+                        _backing.put(key, std::make_shared<const Memcache::Item>(key, request.flags, request.data));
+                        if (!request.noreply) reply(conn, "STORED\r\n");
+                        break;
+                    }
+                    case Command::Delete: {
+                        bool found = _backing.remove(std::string(request.keys[0]));
+                        if (!request.noreply) reply(conn, found ? "DELETED\r\n" : "NOT_FOUND\r\n");
+                        break;
+                    }
+                    case Command::Version:
+                        reply(conn, "VERSION 1.0.0\r\n");
+                        break;
+                    case Command::Quit:
+                        conn.closing = true;
+                        break;
+                    case Command::Unknown:
+                        reply(conn, "ERROR\r\n");
+                        break;
+                    case Command::Malformed:
+                        reply(conn, "CLIENT_ERROR bad command line format\r\n");
+                        break;
+                }
+            }
+
+            int listenTcp() {
+                int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                int one = 1;
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+                sockaddr_in addr{};
+                addr.sin_family = AF_INET;
+                addr.sin_port = htons(_options.port);
+                if (fd < 0 || inet_pton(AF_INET, _options.host.c_str(), &addr.sin_addr) != 1 ||
+                    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+                    if (fd >= 0) ::close(fd);
+                    throw std::runtime_error("Cache_Server: cannot listen on " + _options.host + ":" + std::to_string(_options.port));
+                }
+                return fd;
+            }
+
+            int listenUnix() {
+                sockaddr_un addr{};
+                if (_options.unixPath.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Cache_Server: socket path too long");
+                addr.sun_family = AF_UNIX;
+                std::memcpy(addr.sun_path, _options.unixPath.c_str(), _options.unixPath.size() + 1);
+                ::unlink(_options.unixPath.c_str());
+
+                int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+                    if (fd >= 0) ::close(fd);
+                    throw std::runtime_error("Cache_Server: cannot listen on " + _options.unixPath);
+                }
+                return fd;
+            }
+    };
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace CacheSpace {
+    // Parser for the subset of the memcached text protocol the server speaks:
+    //   get <key>*                 set <key> <flags> <exptime> <bytes> [noreply]
+    //   delete <key> [noreply]     version     quit
+    // There are no cas values, so `gets` is left Unknown and answered ERROR
+    // rather than with a reply a cas client would misread.
+    // Requests are parsed straight out of the connection buffer; keys and the
+    // data block are views into it and stay valid until the buffer is consumed.
+    namespace Memcache {
+        constexpr size_t MAX_KEY_LENGTH = 250;
+        constexpr size_t MAX_LINE_LENGTH = 2048;
+
+        enum class Command { Get, Set, Delete, Version, Quit, Unknown, Malformed };
+
+        enum class ParseStatus {
+            Ok,         // one request parsed, `consumed` bytes used
+            Incomplete, // wait for more input
+            Fatal       // protocol violation the stream cannot recover from
+        };
+
+        struct Request {
+            Command command = Command::Unknown;
+            std::vector<std::string_view> keys;
+            uint32_t flags = 0;
+            std::string_view data;
+            bool noreply = false;
+        };
+
+        inline bool nextToken(const char*& pos, const char* end, std::string_view& token) {
+            while (pos < end && *pos == ' ') pos++;
+            const char* start = pos;
+            while (pos < end && *pos != ' ') pos++;
+            token = std::string_view(start, pos - start);
+            return !token.empty();
+        }
+
+        inline bool parseNumber(std::string_view token, uint64_t& out) {
+            if (token.empty() || token.size() > 19) return false;
+            out = 0;
+            for (char c : token) {
+                if (c < '0' || c > '9') return false;
+                out = out * 10 + (c - '0');
+            }
+            return true;
+        }
+
+        // Parses one request from [begin, end). A set whose data block is not
+        // followed by "\r\n", or a line longer than MAX_LINE_LENGTH, is Fatal;
+        // other bad lines come back as Command::Malformed and are skipped.
+        inline ParseStatus parse(const char* begin, const char* end, size_t maxValueBytes,
+                                 Request& request, size_t& consumed) {
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (!newline) return end - begin > static_cast<std::ptrdiff_t>(MAX_LINE_LENGTH) ? ParseStatus::Fatal : ParseStatus::Incomplete;
+
+            const char* lineEnd = newline > begin && newline[-1] == '\r' ? newline - 1 : newline;
+            const char* pos = begin;
+            consumed = newline + 1 - begin;
+
+            request.keys.clear();
+            request.data = std::string_view();
+            request.flags = 0;
+            request.noreply = false;
+            request.command = Command::Malformed;
+
+            std::string_view name, token;
+            if (!nextToken(pos, lineEnd, name)) return ParseStatus::Ok;
+
+            if (name == "get") {
+                while (nextToken(pos, lineEnd, token)) {
+                    if (token.size() > MAX_KEY_LENGTH) return ParseStatus::Ok;
+                    request.keys.push_back(token);
+                }
+                if (!request.keys.empty()) request.command = Command::Get;
+            } else if (name == "set") {
+                uint64_t flags, exptime, bytes;
+                std::string_view key, flagsToken, exptimeToken, bytesToken;
+                if (!nextToken(pos, lineEnd, key) || key.size() > MAX_KEY_LENGTH ||
+                    !nextToken(pos, lineEnd, flagsToken) || !parseNumber(flagsToken, flags) || flags > UINT32_MAX ||
+                    !nextToken(pos, lineEnd, exptimeToken) || !parseNumber(exptimeToken, exptime) ||
+                    !nextToken(pos, lineEnd, bytesToken) || !parseNumber(bytesToken, bytes)) {
+                    return ParseStatus::Ok;
+                }
+                if (nextToken(pos, lineEnd, token)) {
+                    if (token != "noreply") return ParseStatus::Ok;
+                    request.noreply = true;
+                }
+                // Without a valid length the data block cannot be skipped.
+                if (bytes > maxValueBytes) return ParseStatus::Fatal;
+                if (static_cast<uint64_t>(end - (newline + 1)) < bytes + 2) return ParseStatus::Incomplete;
+
+                const char* data = newline + 1;
+                if (data[bytes] != '\r' || data[bytes + 1] != '\n') return ParseStatus::Fatal;
+
+                request.command = Command::Set;
+                request.keys.push_back(key);
+                request.flags = static_cast<uint32_t>(flags);
+                request.data = std::string_view(data, bytes);
+                consumed += bytes + 2;
+            } else if (name == "delete") {
+                std::string_view key;
+                if (!nextToken(pos, lineEnd, key) || key.size() > MAX_KEY_LENGTH) return ParseStatus::Ok;
+                if (nextToken(pos, lineEnd, token)) {
+                    if (token != "noreply") return ParseStatus::Ok;
+                    request.noreply = true;
+                }
+                request.command = Command::Delete;
+                request.keys.push_back(key);
+            } else if (name == "version") {
+                request.command = Command::Version;
+            } else if (name == "quit") {
+                request.command = Command::Quit;
+            } else {
+                request.command = Command::Unknown;
+            }
+            return ParseStatus::Ok;
+        }
+
+        // A stored value with its "VALUE <key> <flags> <bytes>" line prebuilt,
+        // so a get hit is answered with two iovecs pointing into the item.
+        struct Item {
+            std::string header;
+            std::string data;   // payload followed by "\r\n"
+
+            Item(std::string_view key, uint32_t flags, std::string_view payload) {
+                header.reserve(key.size() + 32);
+                header.append("VALUE ").append(key).append(" ")
+                      .append(std::to_string(flags)).append(" ")
+                      .append(std::to_string(payload.size())).append("\r\n");
+                data.reserve(payload.size() + 2);
+                data.append(payload).append("\r\n");
+            }
+        };
+    }
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace CacheSpace {
+    struct SharedOptions {
+        std::string name = "/kcache";   // shm_open name, or a file path when fileBacked
+        bool fileBacked = false;        // mmap a regular file instead of POSIX shm
+        size_t capacity = 1024;
+        size_t shards = 8;
+    };
+
+    // Sharded LRU that lives entirely in one shared mapping, so every process
+    // on the host that opens the same name shares a single copy. Each shard
+    // is a fixed array of slots (the slab) with a free list, hash chains and
+    // an LRU list linked by slot index rather than by pointer, because the
+    // mapping sits at a different address in each process.
+    //
+    // Shard locks are process-shared robust mutexes. If a process dies while
+    // holding one, the next locker gets EOWNERDEAD; a shard whose `dirty` flag
+    // shows it died mid-update is emptied (it is only a cache) before the lock
+    // is marked consistent, so a crash costs at most one shard's contents.
+    //
+    // Keys and values must be trivially copyable (use fixed-size arrays for
+    // strings). The first process to open a name creates and formats it;
+    // later ones must pass the same capacity and shard count. The segment
+    // outlives the processes until unlinkSegment() is called.
+    template<typename Key, typename Value>
+    class Shared_LRU_Cache : public CachePolicy<Key, Value> {
+        static_assert(std::is_trivially_copyable<Key>::value, "shared cache keys must be trivially copyable");
+        static_assert(std::is_trivially_copyable<Value>::value, "shared cache values must be trivially copyable");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared cache needs lock-free atomics");
+
+        public:
+            explicit Shared_LRU_Cache(const SharedOptions& options):
+                _base(nullptr),
+                _bytes(0),
+                _fd(-1) {
+                    uint32_t shards = static_cast<uint32_t>(std::max<size_t>(options.shards, 1));
+                    uint32_t slots = static_cast<uint32_t>((std::max<size_t>(options.capacity, 1) + shards - 1) / shards);
+                    uint32_t buckets = 1;
+                    while (buckets < slots) buckets <<= 1;
+
+                    _layout.shards = shards;
+                    _layout.slotsPerShard = slots;
+                    _layout.bucketsPerShard = buckets;
+                    _layout.bucketsOffset = alignUp(sizeof(Shard));
+                    _layout.slotsOffset = alignUp(_layout.bucketsOffset + buckets * sizeof(uint32_t));
+                    _layout.shardBytes = alignUp(_layout.slotsOffset + slots * sizeof(Slot));
+                    _bytes = alignUp(sizeof(Header)) + shards * _layout.shardBytes;
+
+                    attach(options);
+                }
+
+            ~Shared_LRU_Cache() override {
+                if (_base) munmap(_base, _bytes);
+                if (_fd >= 0) ::close(_fd);
+            }
+
+            Shared_LRU_Cache(const Shared_LRU_Cache&) = delete;
+            Shared_LRU_Cache& operator=(const Shared_LRU_Cache&) = delete;
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                uint64_t hash = CacheHash<Key>()(key);
+                Shard& shard = shardFor(hash);
+                ShardLock lock(*this, shard);
+
+                uint32_t index = find(shard, hash, key);
+                if (index == NIL) return false;
+
+                Slot& slot = slotAt(shard, index);
+                if (shard.head != index) {
+                    Mutation mutation(shard);
+                    unlinkLru(shard, index);
+                    pushFront(shard, index);
+                }
+                std::memcpy(&value, &slot.value, sizeof(Value));
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                uint64_t hash = CacheHash<Key>()(key);
+                Shard& shard = shardFor(hash);
+                ShardLock lock(*this, shard);
+                Mutation mutation(shard);
+
+                uint32_t index = find(shard, hash, key);
+                if (index != NIL) {
+                    std::memcpy(&slotAt(shard, index).value, &value, sizeof(Value));
+                    unlinkLru(shard, index);
+                    pushFront(shard, index);
+                    return;
+                }
+
+                if (shard.freeList == NIL) release(shard, shard.tail);
+                index = shard.freeList;
+                Slot& slot = slotAt(shard, index);
+                shard.freeList = slot.next;
+
+                std::memcpy(&slot.key, &key, sizeof(Key));
+                std::memcpy(&slot.value, &value, sizeof(Value));
+                slot.hash = hash;
+                uint32_t& bucket = bucketAt(shard, hash);
+                slot.chain = bucket;
+                bucket = index;
+                pushFront(shard, index);
+                shard.size++;
+            }
+
+            void remove(Key key) {
+                uint64_t hash = CacheHash<Key>()(key);
+                Shard& shard = shardFor(hash);
+                ShardLock lock(*this, shard);
+
+                uint32_t index = find(shard, hash, key);
+                if (index == NIL) return;
+                Mutation mutation(shard);
+                release(shard, index);
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (uint32_t i = 0; i < _layout.shards; i++) {
+                    Shard& shard = shardAt(i);
+                    ShardLock lock(*this, shard);
+                    total += shard.size;
+                }
+                return total;
+            }
+
+            // Shard locks taken over from dead processes since the segment was created.
+            uint64_t recoveries() const {
+                return header().recoveries.load(std::memory_order_relaxed);
+            }
+
+            static bool unlinkSegment(const SharedOptions& options) {
+                return options.fileBacked ? ::unlink(options.name.c_str()) == 0
+                                          : shm_unlink(options.name.c_str()) == 0;
+            }
+        private:
+            static constexpr uint32_t NIL = UINT32_MAX;
+            static constexpr uint64_t MAGIC = 0x4b43534852454431ULL;   // "KCSHRED1"
+            static constexpr uint32_t VERSION = 1;
+            static constexpr uint32_t READY = 1;
+
+            struct Layout {
+                uint32_t shards;
+                uint32_t slotsPerShard;
+                uint32_t bucketsPerShard;
+                uint64_t bucketsOffset;
+                uint64_t slotsOffset;
+                uint64_t shardBytes;
+            };
+
+            struct Header {
+                uint64_t magic;
+                uint32_t version;
+                uint32_t keySize;
+                uint32_t valueSize;
+                Layout layout;
+                std::atomic<uint64_t> recoveries;
+                std::atomic<uint32_t> state;
+            };
+
+            struct alignas(64) Shard {
+                pthread_mutex_t mutex;
+                std::atomic<uint32_t> dirty;
+                uint32_t head;
+                uint32_t tail;
+                uint32_t freeList;
+                uint32_t size;
+            };
+
+            struct Slot {
+                Key key;
+                Value value;
+                uint64_t hash;
+                uint32_t prev;
+                uint32_t next;      // LRU list, or the free list
+                uint32_t chain;     // hash bucket chain
+            };
+
+            // Takes the shard lock, recovering it from a dead owner.
+            class ShardLock {
+                public:
+                    ShardLock(Shared_LRU_Cache& cache, Shard& shard): _shard(shard) {
+                        int rc = pthread_mutex_lock(&_shard.mutex);
+                        if (rc == EOWNERDEAD) {
+                            if (_shard.dirty.load(std::memory_order_acquire)) cache.resetShard(_shard);
+                            pthread_mutex_consistent(&_shard.mutex);
+                            cache.header().recoveries.fetch_add(1, std::memory_order_relaxed);
+                        } else if (rc != 0) {
+                            throw std::runtime_error("Shared_LRU_Cache: cannot lock shard");
+                        }
+                    }
+                    ~ShardLock() { pthread_mutex_unlock(&_shard.mutex); }
+                private:
+                    Shard& _shard;
+            };
+
+            // Brackets a structural update so a crash inside it is detectable.
+            class Mutation {
+                public:
+                    explicit Mutation(Shard& shard): _shard(shard) { _shard.dirty.store(1, std::memory_order_seq_cst); }
+                    ~Mutation() { _shard.dirty.store(0, std::memory_order_release); }
+                private:
+                    Shard& _shard;
+            };
+
+            char* _base;
+            size_t _bytes;
+            int _fd;
+            Layout _layout;
+
+            static uint64_t alignUp(uint64_t size) { return (size + 63) & ~uint64_t(63); }
+
+            Header& header() const { return *reinterpret_cast<Header*>(_base); }
+
+            Shard& shardAt(uint32_t i) {
+                return *reinterpret_cast<Shard*>(_base + alignUp(sizeof(Header)) + i * _layout.shardBytes);
+            }
+
+            // The low hash bits pick the bucket, so shards use the high ones.
+            Shard& shardFor(uint64_t hash) { return shardAt(static_cast<uint32_t>((hash >> 32) % _layout.shards)); }
+
+            uint32_t* buckets(Shard& shard) {
+                return reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(&shard) + _layout.bucketsOffset);
+            }
+
+            uint32_t& bucketAt(Shard& shard, uint64_t hash) { return buckets(shard)[hash & (_layout.bucketsPerShard - 1)]; }
+
+            Slot& slotAt(Shard& shard, uint32_t index) {
+                return reinterpret_cast<Slot*>(reinterpret_cast<char*>(&shard) + _layout.slotsOffset)[index];
+            }
+
+            uint32_t find(Shard& shard, uint64_t hash, const Key& key) {
+                for (uint32_t index = bucketAt(shard, hash); index != NIL; index = slotAt(shard, index).chain) {
+                    Slot& slot = slotAt(shard, index);
+                    if (slot.hash == hash && std::memcmp(&slot.key, &key, sizeof(Key)) == 0) return index;
+                }
+                return NIL;
+            }
+
+            void pushFront(Shard& shard, uint32_t index) {
+                Slot& slot = slotAt(shard, index);
+                slot.prev = NIL;
+                slot.next = shard.head;
+                if (shard.head != NIL) slotAt(shard, shard.head).prev = index;
+                shard.head = index;
+                if (shard.tail == NIL) shard.tail = index;
+            }
+
+            void unlinkLru(Shard& shard, uint32_t index) {
+                Slot& slot = slotAt(shard, index);
+                if (slot.prev != NIL) slotAt(shard, slot.prev).next = slot.next;
+                else shard.head = slot.next;
+                if (slot.next != NIL) slotAt(shard, slot.next).prev = slot.prev;
+                else shard.tail = slot.prev;
+            }
+
+            // Unlinks a slot from its chain and the LRU list and frees it.
+            void release(Shard& shard, uint32_t index) {
+                Slot& slot = slotAt(shard, index);
+                uint32_t* link = &bucketAt(shard, slot.hash);
+                while (*link != index) link = &slotAt(shard, *link).chain;
+                *link = slot.chain;
+
+                unlinkLru(shard, index);
+                slot.next = shard.freeList;
+                shard.freeList = index;
+                shard.size--;
+            }
+
+            void resetShard(Shard& shard) {
+                uint32_t* bucket = buckets(shard);
+                for (uint32_t i = 0; i < _layout.bucketsPerShard; i++) bucket[i] = NIL;
+                for (uint32_t i = 0; i < _layout.slotsPerShard; i++) {
+                    slotAt(shard, i).next = i + 1 < _layout.slotsPerShard ? i + 1 : NIL;
+                }
+                shard.head = shard.tail = NIL;
+                shard.freeList = 0;
+                shard.size = 0;
+                shard.dirty.store(0, std::memory_order_release);
+            }
+
+            void attach(const SharedOptions& options) {
+                const char* name = options.name.c_str();
+                bool creator = true;
+                _fd = options.fileBacked ? ::open(name, O_RDWR | O_CREAT | O_EXCL, 0600)
+                                         : shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+                if (_fd < 0 && errno == EEXIST) {
+                    creator = false;
+                    _fd = options.fileBacked ? ::open(name, O_RDWR) : shm_open(name, O_RDWR, 0600);
+                }
+                if (_fd < 0) throw std::runtime_error("Shared_LRU_Cache: cannot open " + options.name);
+
+                if (creator) {
+                    if (ftruncate(_fd, static_cast<off_t>(_bytes)) != 0) fail(options, "cannot size");
+                } else if (!waitForSize()) {
+                    fail(options, "size mismatch");
+                }
+
+                void* addr = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+                if (addr == MAP_FAILED) fail(options, "cannot map");
+                _base = static_cast<char*>(addr);
+
+                if (creator) format();
+                else if (!waitForReady()) fail(options, "not initialized or layout mismatch");
+            }
+
+            [[noreturn]] void fail(const SharedOptions& options, const char* what) {
+                if (_base) munmap(_base, _bytes);
+                ::close(_fd);
+                _base = nullptr;
+                _fd = -1;
+                throw std::runtime_error(std::string("Shared_LRU_Cache: ") + what + " " + options.name);
+            }
+
+            void format() {
+                Header& h = *new (_base) Header();
+                h.magic = MAGIC;
+                h.version = VERSION;
+                h.keySize = sizeof(Key);
+                h.valueSize = sizeof(Value);
+                h.layout = _layout;
+
+                pthread_mutexattr_t attr;
+                pthread_mutexattr_init(&attr);
+                pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+                pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+                for (uint32_t i = 0; i < _layout.shards; i++) {
+                    Shard& shard = *new (&shardAt(i)) Shard();
+                    pthread_mutex_init(&shard.mutex, &attr);
+                    resetShard(shard);
+                }
+                pthread_mutexattr_destroy(&attr);
+
+                h.state.store(READY, std::memory_order_release);
+            }
+
+            // A joining process may race the creator's ftruncate/format.
+            bool waitForSize() {
+                struct stat st;
+                for (int i = 0; i < 1000; i++) {
+                    if (fstat(_fd, &st) != 0) return false;
+                    if (static_cast<size_t>(st.st_size) == _bytes) return true;
+                    if (st.st_size != 0) return false;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return false;
+            }
+
+            bool waitForReady() {
+                Header& h = header();
+                for (int i = 0; i < 1000 && h.state.load(std::memory_order_acquire) != READY; i++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return h.state.load(std::memory_order_acquire) == READY &&
+                    h.magic == MAGIC && h.version == VERSION &&
+                    h.keySize == sizeof(Key) && h.valueSize == sizeof(Value) &&
+                    h.layout.shards == _layout.shards && h.layout.slotsPerShard == _layout.slotsPerShard;
+            }
+    };
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace CacheSpace {
+    // On-disk layout: [header][payload][fnv1a-64 of payload]. The payload is a
+    // policy-specific sequence of sections written through SnapshotCodec.
+    enum class SnapshotPolicy : uint16_t {
+        LRU = 1,
+        LFU = 2,
+        ARC = 3
+    };
+
+    // Trivially copyable types are stored as raw bytes; anything else needs a
+    // specialization (std::string is provided below). Codecs work on any
+    // stream offering writeRaw() or readRaw()/readView().
+    template<typename T, typename Enable = void>
+    struct SnapshotCodec {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "SnapshotCodec must be specialized for non-trivially-copyable types");
+
+        template<typename Writer>
+        static void write(Writer& out, const T& value) {
+            out.writeRaw(&value, sizeof(T));
+        }
+
+        template<typename Reader>
+        static bool read(Reader& in, T& value) {
+            return in.readRaw(&value, sizeof(T));
+        }
+    };
+
+    class SnapshotWriter {
+        public:
+            explicit SnapshotWriter(SnapshotPolicy policy) {
+                _buffer.reserve(4096);
+                writeRaw(&MAGIC, sizeof(MAGIC));
+                writeRaw(&VERSION, sizeof(VERSION));
+                uint16_t tag = static_cast<uint16_t>(policy);
+                writeRaw(&tag, sizeof(tag));
+            }
+
+            template<typename T>
+            void write(const T& value) {
+                SnapshotCodec<T>::write(*this, value);
+            }
+
+            void writeRaw(const void* data, size_t size) {
+                const char* bytes = static_cast<const char*>(data);
+                _buffer.insert(_buffer.end(), bytes, bytes + size);
+            }
+
+            // Writes to a temporary file and renames it over `path`, so a crash
+            // mid-write never leaves a truncated snapshot behind.
+            bool commit(const std::string& path) {
+                uint64_t checksum = fnv1a(_buffer.data() + HEADER_SIZE, _buffer.size() - HEADER_SIZE);
+                writeRaw(&checksum, sizeof(checksum));
+
+                std::string tmpPath = path + ".tmp";
+                FILE* file = std::fopen(tmpPath.c_str(), "wb");
+                if (!file) return false;
+
+                bool ok = std::fwrite(_buffer.data(), 1, _buffer.size(), file) == _buffer.size();
+                ok = (std::fflush(file) == 0) && ok;
+                ok = (fsync(fileno(file)) == 0) && ok;
+                ok = (std::fclose(file) == 0) && ok;
+
+                if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+                    std::remove(tmpPath.c_str());
+                    return false;
+                }
+                return true;
+            }
+
+            static uint64_t fnv1a(const char* data, size_t size) {
+                uint64_t hash = 14695981039346656037ULL;
+                for (size_t i = 0; i < size; i++) {
+                    hash ^= static_cast<unsigned char>(data[i]);
+                    hash *= 1099511628211ULL;
+                }
+                return hash;
+            }
+
+            static constexpr uint32_t MAGIC = 0x4B435353;
+            static constexpr uint16_t VERSION = 2;
+            static constexpr size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(VERSION) + sizeof(uint16_t);
+        private:
+            std::vector<char> _buffer;
+    };
+
+    // Reads a snapshot straight out of an mmap'd file. open() validates the
+    // header and checksum up front, so callers can rebuild their structures in
+    // a single pass without having to roll back on a half-read file.
+    class SnapshotReader {
+        public:
+            SnapshotReader(): _data(nullptr), _size(0), _pos(0), _end(0) {}
+
+            ~SnapshotReader() {
+                if (_data) munmap(const_cast<char*>(_data), _size);
+            }
+
+            SnapshotReader(const SnapshotReader&) = delete;
+            SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+            bool open(const std::string& path, SnapshotPolicy policy) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) return false;
+
+                struct stat st;
+                if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(SnapshotWriter::HEADER_SIZE + sizeof(uint64_t))) {
+                    ::close(fd);
+                    return false;
+                }
+
+                void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if (addr == MAP_FAILED) return false;
+
+                _data = static_cast<const char*>(addr);
+                _size = st.st_size;
+                madvise(addr, _size, MADV_SEQUENTIAL);
+
+                uint32_t magic;
+                uint16_t version, tag;
+                std::memcpy(&magic, _data, sizeof(magic));
+                std::memcpy(&version, _data + sizeof(magic), sizeof(version));
+                std::memcpy(&tag, _data + sizeof(magic) + sizeof(version), sizeof(tag));
+
+                if (magic != SnapshotWriter::MAGIC || version != SnapshotWriter::VERSION ||
+                    tag != static_cast<uint16_t>(policy)) return false;
+
+                _pos = SnapshotWriter::HEADER_SIZE;
+                _end = _size - sizeof(uint64_t);
+
+                uint64_t checksum;
+                std::memcpy(&checksum, _data + _end, sizeof(checksum));
+                return checksum == SnapshotWriter::fnv1a(_data + _pos, _end - _pos);
+            }
+
+            template<typename T>
+            bool read(T& value) {
+                return SnapshotCodec<T>::read(*this, value);
+            }
+
+            bool readRaw(void* out, size_t size) {
+                if (size > _end - _pos) return false;
+                std::memcpy(out, _data + _pos, size);
+                _pos += size;
+                return true;
+            }
+
+            bool readView(const char*& out, size_t size) {
+                if (size > _end - _pos) return false;
+                out = _data + _pos;
+                _pos += size;
+                return true;
+            }
+
+            bool atEnd() const { return _pos == _end; }
+        private:
+            const char* _data;
+            size_t _size;
+            size_t _pos;
+            size_t _end;
+    };
+
+    template<>
+    struct SnapshotCodec<std::string> {
+        template<typename Writer>
+        static void write(Writer& out, const std::string& value) {
+            uint32_t length = static_cast<uint32_t>(value.size());
+            out.writeRaw(&length, sizeof(length));
+            out.writeRaw(value.data(), length);
+        }
+
+        template<typename Reader>
+        static bool read(Reader& in, std::string& value) {
+            uint32_t length;
+            const char* bytes;
+            if (!in.readRaw(&length, sizeof(length)) || !in.readView(bytes, length)) return false;
+            value.assign(bytes, length);
+            return true;
+        }
+    };
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "LRUCore.h"
+#include "../CacheHash.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace CacheSpace {
+    // LRU core for integral keys and trivially copyable values. Entries sit in
+    // one preallocated array and are linked by 32-bit indices; lookups go
+    // through an open-addressing index whose buckets carry the key inline, so
+    // a probe never leaves the index array. No per-entry allocation happens
+    // after construction.
+    //
+    // Reached only through LRUCoreFor (StaticCache, ShardedStaticCache). The
+    // capacity is fixed, and there are no eviction listeners or snapshots, so
+    // LRU_Cache and Hash_LRU_Cache stay node-based even for integral keys.
+    template<typename Key, typename Value>
+    class FlatLRUCore {
+        static_assert(std::is_integral<Key>::value, "FlatLRUCore needs an integral key");
+        static_assert(std::is_trivially_copyable<Value>::value, "FlatLRUCore needs a trivially copyable value");
+        public:
+            using key_type = Key;
+            using value_type = Value;
+
+            explicit FlatLRUCore(size_t capacity):
+                _capacity(capacity),
+                _size(0),
+                _head(NIL),
+                _tail(NIL) {
+                    if (capacity >= NIL / 2) throw std::length_error("FlatLRUCore: capacity too large");
+
+                    size_t buckets = 4;
+                    while (buckets < capacity * 2) buckets <<= 1;
+                    _mask = buckets - 1;
+                    _buckets.assign(buckets, Bucket{Key(), NIL});
+                    _entries.resize(capacity);
+
+                    _freeList.reserve(capacity);
+                    for (size_t i = capacity; i > 0; i--) _freeList.push_back(static_cast<uint32_t>(i - 1));
+                }
+
+            FlatLRUCore(const FlatLRUCore&) = delete;
+            FlatLRUCore& operator=(const FlatLRUCore&) = delete;
+
+            bool get(const Key& key, Value& value) {
+                size_t pos = findBucket(key);
+                if (pos == NPOS) return false;
+
+                uint32_t index = _buckets[pos].entry;
+                moveToFront(index);
+                value = _entries[index].value;
+                return true;
+            }
+
+            bool update(const Key& key, const Value& value) {
+                size_t pos = findBucket(key);
+                if (pos == NPOS) return false;
+
+                uint32_t index = _buckets[pos].entry;
+                _entries[index].value = value;
+                moveToFront(index);
+                return true;
+            }
+
+            void insert(const Key& key, const Value& value) {
+                if (_capacity == 0) return;
+                if (_size >= _capacity) evictLeastRecent();
+
+                uint32_t index = _freeList.back();
+                _freeList.pop_back();
+
+                Entry& entry = _entries[index];
+                entry.key = key;
+                entry.value = value;
+                pushFront(index);
+                _size++;
+
+                size_t pos = CacheHash<Key>()(key) & _mask;
+                while (_buckets[pos].entry != NIL) pos = (pos + 1) & _mask;
+                _buckets[pos] = Bucket{key, index};
+            }
+
+            bool remove(const Key& key) {
+                size_t pos = findBucket(key);
+                if (pos == NPOS) return false;
+
+                uint32_t index = _buckets[pos].entry;
+                eraseBucket(pos);
+                unlink(index);
+                _freeList.push_back(index);
+                _size--;
+                return true;
+            }
+
+            size_t size() const { return _size; }
+
+            size_t capacity() const { return _capacity; }
+        private:
+            static constexpr uint32_t NIL = UINT32_MAX;
+            static constexpr size_t NPOS = SIZE_MAX;
+
+            struct Entry {
+                Key key;
+                Value value;
+                uint32_t prev;
+                uint32_t next;
+            };
+
+            struct Bucket {
+                Key key;
+                uint32_t entry;
+            };
+
+            size_t _capacity;
+            size_t _size;
+            size_t _mask;
+            uint32_t _head;
+            uint32_t _tail;
+
+            std::vector<Entry> _entries;
+            std::vector<Bucket> _buckets;
+            std::vector<uint32_t> _freeList;
+
+            size_t findBucket(const Key& key) const {
+                size_t pos = CacheHash<Key>()(key) & _mask;
+                while (_buckets[pos].entry != NIL) {
+                    if (_buckets[pos].key == key) return pos;
+                    pos = (pos + 1) & _mask;
+                }
+                return NPOS;
+            }
+
+            // Backward-shift deletion keeps linear probing tombstone-free.
+            void eraseBucket(size_t pos) {
+                size_t next = (pos + 1) & _mask;
+                while (_buckets[next].entry != NIL) {
+                    size_t home = CacheHash<Key>()(_buckets[next].key) & _mask;
+                    if (((next - home) & _mask) >= ((next - pos) & _mask)) {
+                        _buckets[pos] = _buckets[next];
+                        pos = next;
+                    }
+                    next = (next + 1) & _mask;
+                }
+                _buckets[pos].entry = NIL;
+            }
+
+            void pushFront(uint32_t index) {
+                Entry& entry = _entries[index];
+                entry.prev = NIL;
+                entry.next = _head;
+                if (_head != NIL) _entries[_head].prev = index;
+                _head = index;
+                if (_tail == NIL) _tail = index;
+            }
+
+            void unlink(uint32_t index) {
+                Entry& entry = _entries[index];
+                if (entry.prev != NIL) _entries[entry.prev].next = entry.next;
+                else _head = entry.next;
+                if (entry.next != NIL) _entries[entry.next].prev = entry.prev;
+                else _tail = entry.prev;
+            }
+
+            void moveToFront(uint32_t index) {
+                if (_head == index) return;
+                unlink(index);
+                pushFront(index);
+            }
+
+            void evictLeastRecent() {
+                remove(_entries[_tail].key);
+            }
+    };
+
+    // Picks FlatLRUCore when the key and value allow it, LRUCore otherwise.
+    template<typename Key, typename Value>
+    using LRUCoreFor = typename std::conditional<is_flat_cacheable<Key, Value>::value,
+        FlatLRUCore<Key, Value>, LRUCore<Key, Value>>::type;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace CacheSpace {
+    // Unsynchronized LRU core for StaticCache. Entries live directly in the
+    // hash table and are linked intrusively, so a hit is one lookup plus a
+    // relink with no shared_ptr traffic. Locking is the wrapper's job.
+    template<typename Key, typename Value>
+    class LRUCore {
+        public:
+            using key_type = Key;
+            using value_type = Value;
+
+            explicit LRUCore(size_t capacity):
+                _capacity(capacity), _head(nullptr), _tail(nullptr) {
+                    _entries.reserve(capacity);
+                }
+
+            LRUCore(const LRUCore&) = delete;
+            LRUCore& operator=(const LRUCore&) = delete;
+
+            bool get(const Key& key, Value& value) {
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return false;
+
+                moveToFront(&it->second);
+                value = it->second.value;
+                return true;
+            }
+
+            bool update(const Key& key, const Value& value) {
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return false;
+
+                it->second.value = value;
+                moveToFront(&it->second);
+                return true;
+            }
+
+            void insert(const Key& key, const Value& value) {
+                if (_capacity == 0) return;
+                if (_entries.size() >= _capacity) evictLeastRecent();
+
+                auto it = _entries.emplace(key, Entry{value, &key, nullptr, nullptr}).first;
+                it->second.key = &it->first;
+                pushFront(&it->second);
+            }
+
+            bool remove(const Key& key) {
+                auto it = _entries.find(key);
+                if (it == _entries.end()) return false;
+
+                unlink(&it->second);
+                _entries.erase(it);
+                return true;
+            }
+
+            size_t size() const { return _entries.size(); }
+
+            size_t capacity() const { return _capacity; }
+        private:
+            struct Entry {
+                Value value;
+                const Key* key;
+                Entry* prev;
+                Entry* next;
+            };
+
+            size_t _capacity;
+            Entry* _head;
+            Entry* _tail;
+            std::unordered_map<Key, Entry> _entries;
+
+            void pushFront(Entry* entry) {
+                entry->prev = nullptr;
+                entry->next = _head;
+                if (_head) _head->prev = entry;
+                _head = entry;
+                if (!_tail) _tail = entry;
+            }
+
+            void unlink(Entry* entry) {
+                if (entry->prev) entry->prev->next = entry->next;
+                else _head = entry->next;
+                if (entry->next) entry->next->prev = entry->prev;
+                else _tail = entry->prev;
+            }
+
+            void moveToFront(Entry* entry) {
+                if (_head == entry) return;
+                unlink(entry);
+                pushFront(entry);
+            }
+
+            void evictLeastRecent() {
+                Entry* victim = _tail;
+                unlink(victim);
+                _entries.erase(_entries.find(*victim->key));
+            }
+    };
+}
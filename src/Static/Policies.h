@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../LRU/KeyHistory.h"
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+namespace CacheSpace {
+    // Building blocks for StaticCache. Each is a plain class with inline
+    // members, so the chosen combination is resolved at compile time and the
+    // empty ones cost nothing.
+
+    // ---- locking -------------------------------------------------------------
+
+    class MutexLock {
+        public:
+            void lock() { _mutex.lock(); }
+            void unlock() { _mutex.unlock(); }
+        private:
+            std::mutex _mutex;
+    };
+
+    // Test-and-test-and-set spinlock for very short critical sections.
+    class SpinLock {
+        public:
+            void lock() {
+                while (_locked.exchange(true, std::memory_order_acquire)) {
+                    for (int spins = 0; _locked.load(std::memory_order_relaxed); spins++) {
+                        if (spins >= 64) {
+                            std::this_thread::yield();
+                            spins = 0;
+                        }
+                    }
+                }
+            }
+
+            void unlock() { _locked.store(false, std::memory_order_release); }
+        private:
+            std::atomic<bool> _locked{false};
+    };
+
+    // For caches confined to a single thread.
+    class NoLock {
+        public:
+            void lock() {}
+            void unlock() {}
+    };
+
+    // ---- statistics ----------------------------------------------------------
+
+    class NoStats {
+        public:
+            void recordHit() {}
+            void recordMiss() {}
+    };
+
+    // Plain counters, updated under the cache's own lock.
+    class CountingStats {
+        public:
+            void recordHit() { _hits++; }
+            void recordMiss() { _misses++; }
+
+            uint64_t hits() const { return _hits; }
+            uint64_t misses() const { return _misses; }
+        private:
+            uint64_t _hits = 0;
+            uint64_t _misses = 0;
+    };
+
+    // ---- admission -----------------------------------------------------------
+
+    class AdmitAll {
+        public:
+            explicit AdmitAll(size_t = 0) {}
+
+            template<typename Key> void recordMiss(const Key&) {}
+            template<typename Key> bool admit(const Key&) { return true; }
+    };
+
+    // Admits a key on its K-th reference. As in LRU_K_Cache, only put()s of
+    // uncached keys count: a get() miss is followed by the put() that fills
+    // it, and counting both would admit on the first reference when K = 2.
+    template<typename Key, unsigned K = 2>
+    class AdmitOnKthReference {
+        public:
+            explicit AdmitOnKthReference(size_t capacity): _history(capacity * 2) {}
+
+            void recordMiss(const Key&) {}
+
+            bool admit(const Key& key) {
+                if (_history.touch(key) < K) return false;
+                _history.erase(key);
+                return true;
+            }
+        private:
+            KeyHistory<Key> _history;
+    };
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "LRUCore.h"
+#include "Policies.h"
+#include "FlatLRUCore.h"
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+
+#include <mutex>
+#include <array>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+namespace CacheSpace {
+    // Compile-time composition of a cache: a core replacement policy wrapped
+    // with a locking, statistics and admission strategy. Nothing on the access
+    // path is virtual, so the whole get/put can be inlined and specialized.
+    //
+    // A Core provides key_type, value_type, a (capacity) constructor, and
+    // get / update / insert / remove with LRUCore's semantics.
+    template<typename Core,
+             typename Lock = MutexLock,
+             typename Stats = NoStats,
+             typename Admission = AdmitAll>
+    class StaticCache {
+        public:
+            using key_type = typename Core::key_type;
+            using value_type = typename Core::value_type;
+
+            explicit StaticCache(size_t capacity): _core(capacity), _admission(capacity) {}
+
+            bool get(const key_type& key, value_type& value) {
+                std::lock_guard<Lock> guard(_lock);
+
+                if (_core.get(key, value)) {
+                    _stats.recordHit();
+                    return true;
+                }
+                _stats.recordMiss();
+                _admission.recordMiss(key);
+                return false;
+            }
+
+            value_type get(const key_type& key) {
+                value_type value{};
+                get(key, value);
+                return value;
+            }
+
+            void put(const key_type& key, const value_type& value) {
+                std::lock_guard<Lock> guard(_lock);
+
+                if (_core.update(key, value)) return;
+                if (_admission.admit(key)) _core.insert(key, value);
+            }
+
+            bool remove(const key_type& key) {
+                std::lock_guard<Lock> guard(_lock);
+                return _core.remove(key);
+            }
+
+            size_t size() {
+                std::lock_guard<Lock> guard(_lock);
+                return _core.size();
+            }
+
+            // Copy of the statistics policy, taken under the lock.
+            Stats stats() {
+                std::lock_guard<Lock> guard(_lock);
+                return _stats;
+            }
+        private:
+            Lock _lock;
+            Core _core;
+            Stats _stats;
+            Admission _admission;
+    };
+
+    // Fixed number of StaticCache shards chosen at compile time; the shard
+    // index is a mask of the key hash and each shard sits on its own cache
+    // line so neighbouring locks do not false-share.
+    template<typename Shard, size_t ShardCount = 16, typename Hash = CacheHash<typename Shard::key_type>>
+    class ShardedStaticCache {
+        static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0,
+            "ShardCount must be a power of two");
+        public:
+            using key_type = typename Shard::key_type;
+            using value_type = typename Shard::value_type;
+
+            explicit ShardedStaticCache(size_t capacity) {
+                size_t size = (capacity + ShardCount - 1) / ShardCount;
+                for (auto& slot : _shards) slot.reset(new AlignedShard(size));
+            }
+
+            bool get(const key_type& key, value_type& value) {
+                return shardFor(key).get(key, value);
+            }
+
+            value_type get(const key_type& key) {
+                return shardFor(key).get(key);
+            }
+
+            void put(const key_type& key, const value_type& value) {
+                shardFor(key).put(key, value);
+            }
+
+            bool remove(const key_type& key) {
+                return shardFor(key).remove(key);
+            }
+
+            size_t size() {
+                size_t total = 0;
+                for (auto& slot : _shards) total += slot->cache.size();
+                return total;
+            }
+        private:
+            struct alignas(64) AlignedShard {
+                explicit AlignedShard(size_t capacity): cache(capacity) {}
+                Shard cache;
+            };
+
+            std::array<std::unique_ptr<AlignedShard>, ShardCount> _shards;
+
+            Shard& shardFor(const key_type& key) {
+                return _shards[Hash()(key) & (ShardCount - 1)]->cache;
+            }
+    };
+
+    // Optional bridge back to the virtual CachePolicy interface, for code that
+    // needs to hold heterogeneous caches behind one pointer.
+    template<typename Cache>
+    class PolicyAdapter : public CachePolicy<typename Cache::key_type, typename Cache::value_type> {
+        public:
+            using Key = typename Cache::key_type;
+            using Value = typename Cache::value_type;
+
+            template<typename... Args>
+            explicit PolicyAdapter(Args&&... args): _cache(std::forward<Args>(args)...) {}
+
+            Value get(Key key) override { return _cache.get(key); }
+
+            bool get(Key key, Value& value) override { return _cache.get(key, value); }
+
+            void put(Key key, Value value) override { _cache.put(key, value); }
+
+            Cache& cache() { return _cache; }
+        private:
+            Cache _cache;
+    };
+}
@@ -0,0 +1,425 @@
+#pragma once
+
+#include "../Snapshot/Snapshot.h"
+
+#include <map>
+#include <new>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace CacheSpace {
+    struct SpillOptions {
+        std::string directory;          // empty: a fresh directory under $TMPDIR
+        size_t segmentBytes = 64 << 20;
+        size_t maxSegments = 16;
+        size_t batchBytes = 256 << 10;
+        double gcLiveRatio = 0.5;
+    };
+
+    // Log-structured on-disk store for entries spilled out of an in-memory
+    // policy. Records are appended to an aligned write batch and flushed to the
+    // active segment in whole blocks (O_DIRECT where the filesystem allows it).
+    // Only a compact (segment, offset, length) location per key is kept in RAM.
+    //
+    // Sealed segments whose live ratio drops below gcLiveRatio are compacted
+    // into the active segment; beyond maxSegments the oldest segment is dropped
+    // along with its entries, which bounds disk usage.
+    //
+    // Segment files are created exclusively, so two stores pointed at the
+    // same directory fail on construction instead of overwriting each other.
+    template<typename Key, typename Value>
+    class SpillStore {
+        public:
+            static constexpr size_t BLOCK_SIZE = 4096;
+
+            explicit SpillStore(const SpillOptions& options):
+                _options(options),
+                _nextSegmentId(0),
+                _activeId(0),
+                _batch(nullptr),
+                _batchSize(0),
+                _batchCapacity(0),
+                _collecting(false) {
+                    _options.batchBytes = alignUp(std::max<size_t>(_options.batchBytes, BLOCK_SIZE));
+                    _options.segmentBytes = std::min<size_t>(std::max(_options.segmentBytes, _options.batchBytes), UINT32_MAX / 2);
+                    _options.maxSegments = std::max<size_t>(_options.maxSegments, 2);
+                    if (_options.directory.empty()) _options.directory = makeTempDirectory();
+                    else mkdir(_options.directory.c_str(), 0755);
+                    openSegment();
+                    reserveBatch(_options.batchBytes);
+                }
+
+            ~SpillStore() {
+                while (!_segments.empty()) destroySegment(_segments.begin()->first);
+                ::rmdir(_options.directory.c_str());
+                std::free(_batch);
+            }
+
+            SpillStore(const SpillStore&) = delete;
+            SpillStore& operator=(const SpillStore&) = delete;
+
+            void put(const Key& key, const Value& value) {
+                RecordWriter record;
+                record.reserve(64);
+                record.writeRaw("\0\0\0\0", sizeof(uint32_t));
+                SnapshotCodec<Key>::write(record, key);
+                SnapshotCodec<Value>::write(record, value);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                dropLocation(key);
+                appendRecord(key, record);
+            }
+
+            bool get(const Key& key, Value& value) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return readValue(key, value);
+            }
+
+            // Reads and drops the entry; used when a disk hit is promoted.
+            bool take(const Key& key, Value& value) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!readValue(key, value)) return false;
+                dropLocation(key);
+                return true;
+            }
+
+            void remove(const Key& key) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                dropLocation(key);
+            }
+
+            size_t size() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _index.size();
+            }
+
+            size_t diskBytes() {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                size_t total = 0;
+                for (const auto& pair : _segments) total += pair.second.size;
+                return total + _batchSize;
+            }
+        private:
+            struct Location {
+                uint32_t segment;
+                uint32_t offset;
+                uint32_t length;
+            };
+
+            struct Segment {
+                int fd;
+                size_t size;
+                size_t liveBytes;
+            };
+
+            class RecordWriter : public std::vector<char> {
+                public:
+                    void writeRaw(const void* data, size_t size) {
+                        const char* bytes = static_cast<const char*>(data);
+                        insert(end(), bytes, bytes + size);
+                    }
+            };
+
+            class RecordReader {
+                public:
+                    RecordReader(const char* data, size_t size): _data(data), _pos(0), _size(size) {}
+
+                    bool readRaw(void* out, size_t size) {
+                        if (size > _size - _pos) return false;
+                        std::memcpy(out, _data + _pos, size);
+                        _pos += size;
+                        return true;
+                    }
+
+                    bool readView(const char*& out, size_t size) {
+                        if (size > _size - _pos) return false;
+                        out = _data + _pos;
+                        _pos += size;
+                        return true;
+                    }
+                private:
+                    const char* _data;
+                    size_t _pos;
+                    size_t _size;
+            };
+
+            SpillOptions _options;
+            std::mutex _mutex;
+
+            uint32_t _nextSegmentId;
+            uint32_t _activeId;
+            std::map<uint32_t, Segment> _segments;
+            std::unordered_map<Key, Location> _index;
+
+            char* _batch;
+            size_t _batchSize;
+            size_t _batchCapacity;
+            bool _collecting;
+
+            static size_t alignUp(size_t n) {
+                return (n + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+            }
+
+            static size_t alignDown(size_t n) {
+                return n & ~(BLOCK_SIZE - 1);
+            }
+
+            static char* allocateAligned(size_t size) {
+                void* ptr = nullptr;
+                if (posix_memalign(&ptr, BLOCK_SIZE, size) != 0) throw std::bad_alloc();
+                return static_cast<char*>(ptr);
+            }
+
+            static std::string makeTempDirectory() {
+                const char* base = std::getenv("TMPDIR");
+                std::string path = std::string(base && *base ? base : "/tmp") + "/spill-XXXXXX";
+                if (!::mkdtemp(&path[0])) throw std::runtime_error("SpillStore: cannot create " + path);
+                return path;
+            }
+
+            std::string segmentPath(uint32_t id) const {
+                return _options.directory + "/segment-" + std::to_string(id) + ".log";
+            }
+
+            void reserveBatch(size_t capacity) {
+                if (capacity <= _batchCapacity) return;
+
+                char* batch = allocateAligned(capacity);
+                if (_batchSize) std::memcpy(batch, _batch, _batchSize);
+                std::free(_batch);
+                _batch = batch;
+                _batchCapacity = capacity;
+            }
+
+            void openSegment() {
+                uint32_t id = _nextSegmentId++;
+                std::string path = segmentPath(id);
+
+                int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+                if (fd < 0 && errno == EEXIST) throw std::runtime_error("SpillStore: " + path + " already exists; is the directory shared?");
+                if (fd < 0) throw std::runtime_error("SpillStore: cannot open " + path);
+#ifdef O_DIRECT
+                // Best effort: filesystems without O_DIRECT (tmpfs) keep buffered I/O.
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_DIRECT);
+#endif
+
+                _segments[id] = Segment{fd, 0, 0};
+                _activeId = id;
+            }
+
+            void destroySegment(uint32_t id) {
+                auto it = _segments.find(id);
+                if (it == _segments.end()) return;
+
+                if (it->second.fd >= 0) ::close(it->second.fd);
+                ::unlink(segmentPath(id).c_str());
+                _segments.erase(it);
+            }
+
+            void appendRecord(const Key& key, std::vector<char>& record) {
+                uint32_t length = static_cast<uint32_t>(record.size());
+                std::memcpy(record.data(), &length, sizeof(length));
+
+                Segment& active = _segments[_activeId];
+                if (active.size + alignUp(_batchSize + length) > _options.segmentBytes && active.size + _batchSize > 0) {
+                    sealActive();
+                }
+                if (_batchSize + length > _batchCapacity) {
+                    if (_batchSize > 0) flushBatch();
+                    reserveBatch(alignUp(length));
+                }
+
+                Segment& target = _segments[_activeId];
+                Location loc{_activeId, static_cast<uint32_t>(target.size + _batchSize), length};
+                std::memcpy(_batch + _batchSize, record.data(), length);
+                _batchSize += length;
+
+                target.liveBytes += length;
+                _index[key] = loc;
+
+                if (_batchSize >= _options.batchBytes) flushBatch();
+            }
+
+            // Writes the batch padded to a whole number of blocks. Unless the
+            // batch ends exactly on a block boundary, the padding starts with a
+            // zero length word (an extra block is added when fewer than four
+            // bytes are left), which marks the end of the batch for a scan.
+            void flushBatch() {
+                if (_batchSize == 0) return;
+
+                size_t padded = alignUp(_batchSize);
+                if (padded != _batchSize && padded - _batchSize < sizeof(uint32_t)) {
+                    padded += BLOCK_SIZE;
+                    reserveBatch(padded);
+                }
+                Segment& active = _segments[_activeId];
+                std::memset(_batch + _batchSize, 0, padded - _batchSize);
+
+                size_t written = 0;
+                while (written < padded) {
+                    ssize_t n = pwrite(active.fd, _batch + written, padded - written, active.size + written);
+                    if (n <= 0) throw std::runtime_error("SpillStore: write failed");
+                    written += n;
+                }
+
+                active.size += padded;
+                _batchSize = 0;
+            }
+
+            void sealActive() {
+                flushBatch();
+                openSegment();
+                collectGarbage();
+            }
+
+            bool readValue(const Key& key, Value& value) {
+                auto it = _index.find(key);
+                if (it == _index.end()) return false;
+
+                std::vector<char> buffer;
+                const char* record = readRecord(it->second, buffer);
+                if (!record) return false;
+
+                RecordReader reader(record + sizeof(uint32_t), it->second.length - sizeof(uint32_t));
+                Key storedKey;
+                return SnapshotCodec<Key>::read(reader, storedKey) && SnapshotCodec<Value>::read(reader, value);
+            }
+
+            // Returns a pointer to the record bytes, either inside the pending
+            // batch or inside `scratch` after an aligned pread; nullptr when the
+            // segment is gone.
+            const char* readRecord(const Location& loc, std::vector<char>& scratch) {
+                auto found = _segments.find(loc.segment);
+                if (found == _segments.end()) return nullptr;
+
+                Segment& segment = found->second;
+                if (loc.segment == _activeId && loc.offset >= segment.size) {
+                    return _batch + (loc.offset - segment.size);
+                }
+
+                size_t begin = alignDown(loc.offset);
+                size_t end = alignUp(loc.offset + loc.length);
+                char* aligned = allocateAligned(end - begin);
+
+                size_t done = 0;
+                while (done < end - begin) {
+                    ssize_t n = pread(segment.fd, aligned + done, end - begin - done, begin + done);
+                    if (n <= 0) break;
+                    done += n;
+                }
+
+                scratch.assign(aligned + (loc.offset - begin), aligned + (loc.offset - begin) + loc.length);
+                std::free(aligned);
+                return scratch.data();
+            }
+
+            void dropLocation(const Key& key) {
+                auto it = _index.find(key);
+                if (it == _index.end()) return;
+
+                auto segment = _segments.find(it->second.segment);
+                if (segment != _segments.end()) segment->second.liveBytes -= it->second.length;
+                _index.erase(it);
+            }
+
+            void collectGarbage() {
+                if (_collecting) return;
+                _collecting = true;
+
+                std::vector<uint32_t> sparse;
+                for (const auto& pair : _segments) {
+                    if (pair.first == _activeId) continue;
+                    if (pair.second.liveBytes < _options.gcLiveRatio * pair.second.size) sparse.push_back(pair.first);
+                }
+                for (uint32_t id : sparse) {
+                    if (_segments.count(id)) releaseSegment(id, true);
+                }
+
+                while (_segments.size() > _options.maxSegments) {
+                    releaseSegment(_segments.begin()->first, false);
+                }
+
+                _collecting = false;
+            }
+
+            // Scans a sealed segment: live records are copied into the active
+            // segment when `relocate` is set, otherwise they are evicted.
+            void releaseSegment(uint32_t id, bool relocate) {
+                Segment& segment = _segments[id];
+                char* data = allocateAligned(std::max(segment.size, BLOCK_SIZE));
+
+                size_t done = 0;
+                while (done < segment.size) {
+                    ssize_t n = pread(segment.fd, data + done, segment.size - done, done);
+                    if (n <= 0) break;
+                    done += n;
+                }
+
+                size_t pos = 0;
+                while (pos + sizeof(uint32_t) <= done) {
+                    uint32_t length;
+                    std::memcpy(&length, data + pos, sizeof(length));
+                    if (length == 0) {
+                        pos = alignUp(pos + 1);
+                        continue;
+                    }
+                    if (pos + length > done) break;
+
+                    RecordReader reader(data + pos + sizeof(uint32_t), length - sizeof(uint32_t));
+                    Key key;
+                    if (SnapshotCodec<Key>::read(reader, key)) {
+                        auto it = _index.find(key);
+                        if (it != _index.end() && it->second.segment == id && it->second.offset == pos) {
+                            segment.liveBytes -= length;
+                            _index.erase(it);
+                            if (relocate) {
+                                std::vector<char> record(data + pos, data + pos + length);
+                                appendRecord(key, record);
+                            }
+                        }
+                    }
+                    pos += length;
+                }
+                std::free(data);
+
+                // Every live record should have been found by the scan; if one
+                // was not, move it by its index entry so none is left pointing
+                // into a deleted file.
+                if (segment.liveBytes > 0) evacuate(id, relocate);
+                destroySegment(id);
+            }
+
+            void evacuate(uint32_t id, bool relocate) {
+                std::vector<Key> keys;
+                for (const auto& pair : _index) {
+                    if (pair.second.segment == id) keys.push_back(pair.first);
+                }
+
+                std::vector<char> buffer;
+                for (const Key& key : keys) {
+                    auto it = _index.find(key);
+                    Location loc = it->second;
+                    const char* record = relocate ? readRecord(loc, buffer) : nullptr;
+                    std::vector<char> copy;
+                    if (record) copy.assign(record, record + loc.length);
+
+                    _segments[id].liveBytes -= loc.length;
+                    _index.erase(it);
+                    if (record) appendRecord(key, copy);
+                }
+            }
+    };
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "SpillStore.h"
+#include "../CacheHash.h"
+#include "../CachePolicy.h"
+#include "../LRU/LRUCache.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace CacheSpace {
+    // Two-tier cache: an in-memory policy (LRU_Cache or Hash_LRU_Cache) in
+    // front of a SpillStore. Entries evicted from memory are spilled to disk,
+    // and a disk hit is promoted back into memory.
+    //
+    // Evictions reach the disk through the batch eviction listener, which
+    // runs after the memory tier's lock is released and only stages them on
+    // the calling thread; the operation writes them out once it has dropped
+    // its own stripe lock. A promotion, put() and remove() of one key are
+    // serialized by a striped mutex, and every put() or remove() stamps its
+    // stripe with a sequence number: a staged entry whose stripe was written
+    // after the evicting operation started is dropped instead of spilled, so
+    // a late spill can never bring back an older value. Lock order is
+    // stripe -> memory tier -> disk tier.
+    template<typename Key, typename Value, typename MemoryCache = LRU_Cache<Key, Value>>
+    class Tiered_Cache : public CachePolicy<Key, Value> {
+        public:
+            template<typename... Args>
+            explicit Tiered_Cache(const SpillOptions& options, Args&&... memoryArgs):
+                _memory(std::make_unique<MemoryCache>(std::forward<Args>(memoryArgs)...)),
+                _disk(std::make_unique<SpillStore<Key, Value>>(options)),
+                _sequence(0),
+                _memoryHits(0),
+                _diskHits(0) {
+                    _writes.fill(0);
+                    _memory->setBatchEvictionListener([](const std::pair<Key, Value>* entries, size_t count) {
+                        std::vector<std::pair<Key, Value>>& list = staged();
+                        list.insert(list.end(), entries, entries + count);
+                    });
+                }
+            ~Tiered_Cache() override {
+                _memory->setBatchEvictionListener(nullptr);
+            }
+
+            Value get(Key key) override {
+                Value value{};
+                get(key, value);
+                return value;
+            }
+
+            bool get(Key key, Value& value) override {
+                if (_memory->get(key, value)) {
+                    _memoryHits++;
+                    return true;
+                }
+
+                uint64_t start;
+                {
+                    std::lock_guard<std::mutex> lock(stripe(key));
+                    if (_memory->get(key, value)) {
+                        _memoryHits++;
+                        return true;
+                    }
+                    if (!_disk->take(key, value)) return false;
+                    _diskHits++;
+                    start = _sequence.load();
+                    _memory->put(key, value);
+                }
+                spill(start, 0);
+                return true;
+            }
+
+            void put(Key key, Value value) override {
+                uint64_t start, mine;
+                {
+                    std::lock_guard<std::mutex> lock(stripe(key));
+                    start = _sequence.load();
+                    _disk->remove(key);
+                    _memory->put(key, value);
+                    mine = written(key);
+                }
+                spill(start, mine);
+            }
+
+            void remove(Key key) {
+                std::lock_guard<std::mutex> lock(stripe(key));
+                _memory->remove(key);
+                _disk->remove(key);
+                written(key);
+            }
+
+            size_t memoryHits() const { return _memoryHits.load(std::memory_order_relaxed); }
+
+            size_t diskHits() const { return _diskHits.load(std::memory_order_relaxed); }
+
+            size_t diskEntries() { return _disk->size(); }
+
+            size_t diskBytes() { return _disk->diskBytes(); }
+        private:
+            static constexpr size_t STRIPES = 64;
+
+            std::unique_ptr<MemoryCache> _memory;
+            std::unique_ptr<SpillStore<Key, Value>> _disk;
+            std::array<std::mutex, STRIPES> _stripes;
+            std::array<uint64_t, STRIPES> _writes;      // last write sequence per stripe, guarded by the stripe
+            std::atomic<uint64_t> _sequence;
+
+            std::atomic<size_t> _memoryHits;
+            std::atomic<size_t> _diskHits;
+
+            // Operations on one thread never nest, so a single list per thread
+            // only ever holds the current operation's evictions.
+            static std::vector<std::pair<Key, Value>>& staged() {
+                thread_local std::vector<std::pair<Key, Value>> list;
+                return list;
+            }
+
+            static size_t stripeOf(const Key& key) {
+                return CacheHash<Key>()(key) % STRIPES;
+            }
+
+            std::mutex& stripe(const Key& key) {
+                return _stripes[stripeOf(key)];
+            }
+
+            // Called with the key's stripe held.
+            uint64_t written(const Key& key) {
+                uint64_t sequence = ++_sequence;
+                _writes[stripeOf(key)] = sequence;
+                return sequence;
+            }
+
+            // Spills what the operation that started at `start` evicted. `mine`
+            // is that operation's own stamp, which does not count as a later
+            // write.
+            void spill(uint64_t start, uint64_t mine) {
+                std::vector<std::pair<Key, Value>> entries;
+                entries.swap(staged());
+
+                for (auto& entry : entries) {
+                    size_t index = stripeOf(entry.first);
+                    std::lock_guard<std::mutex> lock(_stripes[index]);
+                    if (_writes[index] > start && _writes[index] != mine) continue;
+                    _disk->put(entry.first, entry.second);
+                }
+            }
+    };
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+#include "../CacheHash.h"
+
+#include <cmath>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+namespace CacheSpace {
+    // Seeded generator for workloads: splitmix64, one add and a mixHash per
+    // number, and the same sequence for the same seed on every platform
+    // (unlike the std:: distributions, whose output is implementation-defined).
+    class WorkloadRandom {
+        public:
+            explicit WorkloadRandom(uint64_t seed): _state(seed) {}
+
+            uint64_t next() {
+                _state += 0x9e3779b97f4a7c15ULL;
+                return mixHash(_state);
+            }
+
+            // Uniform in [0, 1).
+            double nextDouble() {
+                return (next() >> 11) * 0x1.0p-53;
+            }
+
+            // Uniform in [0, bound), by multiply-shift instead of a division.
+            uint64_t nextBelow(uint64_t bound) {
+                return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+            }
+        private:
+            uint64_t _state;
+    };
+
+    // Zipf ranks in [0, items) with P(rank) ~ 1 / (rank + 1)^skew, rank 0 the
+    // most popular. Rejection-inversion sampling (Hörmann & Derflinger):
+    // O(1) setup and O(1) expected time per sample for any skew > 0, so
+    // there is no zeta table over the key space and the skew may exceed 1.
+    class ZipfSampler {
+        public:
+            ZipfSampler(uint64_t items, double skew):
+                _items(std::max<uint64_t>(items, 1)),
+                _skew(std::max(skew, 1e-6)) {
+                    _integralX1 = hIntegral(1.5) - 1.0;
+                    _integralN = hIntegral(static_cast<double>(_items) + 0.5);
+                    _s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+                }
+
+            uint64_t sample(WorkloadRandom& random) const {
+                while (true) {
+                    double u = _integralN + random.nextDouble() * (_integralX1 - _integralN);
+                    double x = hIntegralInverse(u);
+                    double k = std::floor(x + 0.5);
+                    if (k < 1.0) k = 1.0;
+                    else if (k > static_cast<double>(_items)) k = static_cast<double>(_items);
+                    if (k - x <= _s || u >= hIntegral(k + 0.5) - h(k)) return static_cast<uint64_t>(k) - 1;
+                }
+            }
+
+            uint64_t items() const { return _items; }
+        private:
+            uint64_t _items;
+            double _skew;
+            double _integralX1;
+            double _integralN;
+            double _s;
+
+            double h(double x) const { return std::exp(-_skew * std::log(x)); }
+
+            double hIntegral(double x) const {
+                double logX = std::log(x);
+                return helper2((1.0 - _skew) * logX) * logX;
+            }
+
+            double hIntegralInverse(double x) const {
+                double t = x * (1.0 - _skew);
+                if (t < -1.0) t = -1.0;
+                return std::exp(helper1(t) * x);
+            }
+
+            // log1p(x) / x and expm1(x) / x, with their series near 0.
+            static double helper1(double x) {
+                return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+            }
+
+            static double helper2(double x) {
+                return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+            }
+    };
+
+    // Source of integer keys; keys() is how many distinct keys it draws from.
+    // Generators are single-threaded and fully determined by their
+    // constructor arguments.
+    class KeyGenerator {
+        public:
+            virtual ~KeyGenerator() = default;
+            virtual uint64_t next() = 0;
+            virtual uint64_t keys() const = 0;
+    };
+
+    class UniformKeys : public KeyGenerator {
+        public:
+            UniformKeys(uint64_t keys, uint64_t seed): _keys(std::max<uint64_t>(keys, 1)), _random(seed) {}
+
+            uint64_t next() override { return _random.nextBelow(_keys); }
+            uint64_t keys() const override { return _keys; }
+        private:
+            uint64_t _keys;
+            WorkloadRandom _random;
+    };
+
+    // Key k has rank k: hot keys are small and adjacent.
+    class ZipfianKeys : public KeyGenerator {
+        public:
+            ZipfianKeys(uint64_t keys, double skew, uint64_t seed): _zipf(keys, skew), _random(seed) {}
+
+            uint64_t next() override { return _zipf.sample(_random); }
+            uint64_t keys() const override { return _zipf.items(); }
+        private:
+            ZipfSampler _zipf;
+            WorkloadRandom _random;
+    };
+
+    // Zipf ranks hashed over the key space, so hot keys are spread out as in
+    // YCSB's default request distribution. Like YCSB, the hash is not a
+    // permutation: a few keys collect more than one rank.
+    class ScrambledZipfianKeys : public KeyGenerator {
+        public:
+            ScrambledZipfianKeys(uint64_t keys, double skew, uint64_t seed): _zipf(keys, skew), _random(seed) {}
+
+            uint64_t next() override { return mixHash(_zipf.sample(_random)) % _zipf.items(); }
+            uint64_t keys() const override { return _zipf.items(); }
+        private:
+            ZipfSampler _zipf;
+            WorkloadRandom _random;
+    };
+
+    // Recently inserted keys are the most popular: rank r is key
+    // (inserted - 1 - r). grow() records an insert; the sampler is rebuilt in
+    // O(1).
+    class LatestKeys : public KeyGenerator {
+        public:
+            LatestKeys(uint64_t inserted, double skew, uint64_t seed):
+                _inserted(std::max<uint64_t>(inserted, 1)),
+                _skew(skew),
+                _zipf(_inserted, skew),
+                _random(seed) {}
+
+            uint64_t next() override { return _inserted - 1 - _zipf.sample(_random); }
+            uint64_t keys() const override { return _inserted; }
+
+            uint64_t grow() {
+                _zipf = ZipfSampler(++_inserted, _skew);
+                return _inserted - 1;
+            }
+        private:
+            uint64_t _inserted;
+            double _skew;
+            ZipfSampler _zipf;
+            WorkloadRandom _random;
+    };
+
+    // One pass over fresh keys: start, start + 1, ... Nothing repeats, so
+    // every access is a miss and a cache can only lose by admitting them.
+    class ScanKeys : public KeyGenerator {
+        public:
+            explicit ScanKeys(uint64_t start = 0): _start(start), _next(start) {}
+
+            uint64_t next() override { return _next++; }
+            uint64_t keys() const override { return _next - _start; }
+        private:
+            uint64_t _start;
+            uint64_t _next;
+    };
+
+    // 0, 1, ..., length - 1 over and over. Recency-based policies get no
+    // hits once the loop is longer than the cache.
+    class LoopKeys : public KeyGenerator {
+        public:
+            explicit LoopKeys(uint64_t length): _length(std::max<uint64_t>(length, 1)), _next(0) {}
+
+            uint64_t next() override {
+                uint64_t key = _next;
+                if (++_next == _length) _next = 0;
+                return key;
+            }
+            uint64_t keys() const override { return _length; }
+        private:
+            uint64_t _length;
+            uint64_t _next;
+    };
+
+    // Zipf over a hot set of `hotKeys` keys that moves to a disjoint range
+    // every `phaseLength` accesses, wrapping around the key space. Tests how
+    // quickly a policy lets go of the previous phase's frequent keys.
+    class PhaseShiftKeys : public KeyGenerator {
+        public:
+            PhaseShiftKeys(uint64_t keys, uint64_t hotKeys, uint64_t phaseLength, double skew, uint64_t seed):
+                _keys(std::max<uint64_t>(keys, 1)),
+                _zipf(std::min(std::max<uint64_t>(hotKeys, 1), _keys), skew),
+                _phaseLength(std::max<uint64_t>(phaseLength, 1)),
+                _count(0),
+                _random(seed) {}
+
+            uint64_t next() override {
+                uint64_t offset = (_count++ / _phaseLength) * _zipf.items();
+                return (offset + mixHash(_zipf.sample(_random)) % _zipf.items()) % _keys;
+            }
+            uint64_t keys() const override { return _keys; }
+        private:
+            uint64_t _keys;
+            ZipfSampler _zipf;
+            uint64_t _phaseLength;
+            uint64_t _count;
+            WorkloadRandom _random;
+    };
+
+    // Draws from `second` with probability `ratio` and from `first`
+    // otherwise, e.g. a zipfian working set interrupted by a scan.
+    class MixedKeys : public KeyGenerator {
+        public:
+            MixedKeys(std::unique_ptr<KeyGenerator> first, std::unique_ptr<KeyGenerator> second, double ratio, uint64_t seed):
+                _first(std::move(first)),
+                _second(std::move(second)),
+                _ratio(ratio),
+                _random(seed) {}
+
+            uint64_t next() override { return _random.nextDouble() < _ratio ? _second->next() : _first->next(); }
+            uint64_t keys() const override { return _first->keys() + _second->keys(); }
+        private:
+            std::unique_ptr<KeyGenerator> _first;
+            std::unique_ptr<KeyGenerator> _second;
+            double _ratio;
+            WorkloadRandom _random;
+    };
+
+    enum class OperationType { Read, Update, Insert, Scan, ReadModifyWrite };
+
+    struct Operation {
+        OperationType type;
+        uint64_t key;
+        uint32_t length;    // keys covered by a Scan, 1 otherwise
+    };
+
+    // Stream of operations over integer keys.
+    class Workload {
+        public:
+            virtual ~Workload() = default;
+            virtual Operation next() = 0;
+            virtual std::string name() const = 0;
+    };
+
+    // Reads only, keys from any generator.
+    class ReadWorkload : public Workload {
+        public:
+            ReadWorkload(std::string name, std::unique_ptr<KeyGenerator> keys):
+                _name(std::move(name)),
+                _keys(std::move(keys)) {}
+
+            Operation next() override { return Operation{OperationType::Read, _keys->next(), 1}; }
+            std::string name() const override { return _name; }
+        private:
+            std::string _name;
+            std::unique_ptr<KeyGenerator> _keys;
+    };
+
+    // The YCSB core workloads over `records` preloaded keys:
+    //   A  50% read, 50% update, zipfian       (session store)
+    //   B  95% read, 5% update, zipfian        (photo tagging)
+    //   C  100% read, zipfian                  (user profile cache)
+    //   D  95% read, 5% insert, latest         (status updates)
+    //   E  95% scan (1-100 keys), 5% insert    (threaded conversations)
+    //   F  50% read, 50% read-modify-write     (user database)
+    // Zipfian means scrambled, skew 0.99 by default, as in YCSB. Inserts
+    // append new keys after the existing ones.
+    class YCSBWorkload : public Workload {
+        public:
+            static constexpr uint32_t MAX_SCAN = 100;
+
+            YCSBWorkload(char type, uint64_t records, uint64_t seed, double skew = 0.99):
+                _type(static_cast<char>(std::toupper(static_cast<unsigned char>(type)))),
+                _records(std::max<uint64_t>(records, 1)),
+                _random(seed),
+                _zipf(_records, skew),
+                _latest(_records, skew, mixHash(seed)) {
+                    switch (_type) {
+                        case 'A': _mix = {0.5, 0.5, 0.0, 0.0, 0.0}; break;
+                        case 'B': _mix = {0.95, 0.05, 0.0, 0.0, 0.0}; break;
+                        case 'D': _mix = {0.95, 0.0, 0.05, 0.0, 0.0}; break;
+                        case 'E': _mix = {0.0, 0.0, 0.05, 0.95, 0.0}; break;
+                        case 'F': _mix = {0.5, 0.0, 0.0, 0.0, 0.5}; break;
+                        default: _type = 'C'; _mix = {1.0, 0.0, 0.0, 0.0, 0.0}; break;
+                    }
+                }
+
+            Operation next() override {
+                double roll = _random.nextDouble();
+                if ((roll -= _mix.insert) < 0) {
+                    return Operation{OperationType::Insert, _latest.grow(), 1};
+                }
+                if ((roll -= _mix.scan) < 0) {
+                    uint32_t length = static_cast<uint32_t>(_random.nextBelow(MAX_SCAN)) + 1;
+                    return Operation{OperationType::Scan, chooseKey(), length};
+                }
+                if ((roll -= _mix.update) < 0) return Operation{OperationType::Update, chooseKey(), 1};
+                if ((roll -= _mix.readModifyWrite) < 0) return Operation{OperationType::ReadModifyWrite, chooseKey(), 1};
+                return Operation{OperationType::Read, chooseKey(), 1};
+            }
+
+            std::string name() const override { return std::string("ycsb-") + _type; }
+        private:
+            struct Mix {
+                double read, update, insert, scan, readModifyWrite;
+            };
+
+            char _type;
+            uint64_t _records;
+            Mix _mix;
+            WorkloadRandom _random;
+            ZipfSampler _zipf;
+            LatestKeys _latest;
+
+            // D reads the newest records; the others scramble zipfian ranks
+            // over everything inserted so far.
+            uint64_t chooseKey() {
+                if (_type == 'D') return _latest.next();
+                return mixHash(_zipf.sample(_random)) % _latest.keys();
+            }
+    };
+}
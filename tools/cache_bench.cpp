@@ -0,0 +1,258 @@
+#include "../src/Timer.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// cache_server 的本机压测工具：每个线程一条连接，按流水线深度批量发送请求
+// 用法: cache_bench [--host ADDR] [--port N] [--unix PATH] [--threads N] [--seconds N]
+//                   [--depth N] [--keys N] [--value-size N] [--set-ratio R] [--multiget N]
+namespace {
+    struct Config {
+        std::string host = "127.0.0.1";
+        uint16_t port = 11311;
+        std::string unixPath;
+        int threads = 4;
+        int seconds = 5;
+        int depth = 16;             // 每批流水线请求数
+        int keys = 100000;
+        int valueSize = 100;
+        double setRatio = 0.1;
+        int multiget = 1;           // 每个 get 请求携带的键数
+    };
+
+    struct Totals {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> keysRequested{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> errors{0};
+    };
+
+    void usage(const char* program) {
+        std::cerr << "usage: " << program << " [--host ADDR] [--port N] [--unix PATH] [--threads N] [--seconds N]"
+                  << " [--depth N] [--keys N] [--value-size N] [--set-ratio R] [--multiget N]" << std::endl;
+        std::exit(2);
+    }
+
+    Config parseArgs(int argc, char** argv) {
+        Config config;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) usage(argv[0]);
+            const char* value = argv[++i];
+
+            if (arg == "--host") config.host = value;
+            else if (arg == "--port") config.port = static_cast<uint16_t>(std::atoi(value));
+            else if (arg == "--unix") config.unixPath = value;
+            else if (arg == "--threads") config.threads = std::max(1, std::atoi(value));
+            else if (arg == "--seconds") config.seconds = std::max(1, std::atoi(value));
+            else if (arg == "--depth") config.depth = std::max(1, std::atoi(value));
+            else if (arg == "--keys") config.keys = std::max(1, std::atoi(value));
+            else if (arg == "--value-size") config.valueSize = std::max(0, std::atoi(value));
+            else if (arg == "--set-ratio") config.setRatio = std::atof(value);
+            else if (arg == "--multiget") config.multiget = std::max(1, std::atoi(value));
+            else usage(argv[0]);
+        }
+        return config;
+    }
+
+    int connectTo(const Config& config) {
+        int fd;
+        if (!config.unixPath.empty()) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, config.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        } else {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(config.port);
+            inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr);
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        }
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+
+    bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::write(fd, data.data() + sent, data.size() - sent);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    // 逐条解析响应，直到读完 `expected` 个完整响应
+    class ResponseReader {
+        public:
+            explicit ResponseReader(int fd): _fd(fd), _pos(0) {}
+
+            bool readResponses(int expected, uint64_t& hits, uint64_t& errors) {
+                while (expected > 0) {
+                    std::string line;
+                    if (!readLine(line)) return false;
+
+                    if (line.compare(0, 6, "VALUE ") == 0) {
+                        size_t bytes = std::strtoull(line.c_str() + line.rfind(' ') + 1, nullptr, 10);
+                        if (!skip(bytes + 2)) return false;
+                        hits++;
+                        continue;
+                    }
+                    if (line.find("ERROR") != std::string::npos) errors++;
+                    expected--;
+                }
+                return true;
+            }
+        private:
+            int _fd;
+            std::string _buffer;
+            size_t _pos;
+
+            bool fill() {
+                if (_pos > 0) {
+                    _buffer.erase(0, _pos);
+                    _pos = 0;
+                }
+                char chunk[64 << 10];
+                ssize_t n = ::read(_fd, chunk, sizeof(chunk));
+                if (n <= 0) return false;
+                _buffer.append(chunk, n);
+                return true;
+            }
+
+            bool readLine(std::string& line) {
+                size_t end;
+                while ((end = _buffer.find("\r\n", _pos)) == std::string::npos) {
+                    if (!fill()) return false;
+                }
+                line.assign(_buffer, _pos, end - _pos);
+                _pos = end + 2;
+                return true;
+            }
+
+            bool skip(size_t bytes) {
+                while (_buffer.size() - _pos < bytes) {
+                    if (!fill()) return false;
+                }
+                _pos += bytes;
+                return true;
+            }
+    };
+
+    void runClient(const Config& config, int id, std::chrono::steady_clock::time_point deadline, Totals& totals) {
+        int fd = connectTo(config);
+        if (fd < 0) {
+            std::cerr << "cache_bench: cannot connect" << std::endl;
+            totals.errors++;
+            return;
+        }
+
+        std::mt19937 gen(id * 7919 + 1);
+        std::uniform_int_distribution<int> keyDist(0, config.keys - 1);
+        std::uniform_real_distribution<double> opDist(0.0, 1.0);
+        std::string payload(config.valueSize, 'x');
+        std::string batch;
+        ResponseReader reader(fd);
+
+        uint64_t requests = 0, keysRequested = 0, hits = 0, errors = 0;
+        while (std::chrono::steady_clock::now() < deadline) {
+            batch.clear();
+            for (int i = 0; i < config.depth; i++) {
+                if (opDist(gen) < config.setRatio) {
+                    batch += "set key" + std::to_string(keyDist(gen)) + " 0 0 " + std::to_string(payload.size()) + "\r\n";
+                    batch += payload;
+                    batch += "\r\n";
+                    keysRequested++;
+                } else {
+                    batch += "get";
+                    for (int k = 0; k < config.multiget; k++) batch += " key" + std::to_string(keyDist(gen));
+                    batch += "\r\n";
+                    keysRequested += config.multiget;
+                }
+            }
+            if (!sendAll(fd, batch) || !reader.readResponses(config.depth, hits, errors)) {
+                errors++;
+                break;
+            }
+            requests += config.depth;
+        }
+        ::close(fd);
+
+        totals.requests += requests;
+        totals.keysRequested += keysRequested;
+        totals.hits += hits;
+        totals.errors += errors;
+    }
+
+    // 先把所有键写入一遍，使读取命中率不受冷启动影响
+    bool preload(const Config& config) {
+        int fd = connectTo(config);
+        if (fd < 0) return false;
+
+        ResponseReader reader(fd);
+        std::string payload(config.valueSize, 'x');
+        std::string batch;
+        uint64_t hits = 0, errors = 0;
+        const int BATCH = 256;
+        for (int start = 0; start < config.keys; start += BATCH) {
+            batch.clear();
+            int count = std::min(BATCH, config.keys - start);
+            for (int key = start; key < start + count; key++) {
+                batch += "set key" + std::to_string(key) + " 0 0 " + std::to_string(payload.size()) + "\r\n" + payload + "\r\n";
+            }
+            if (!sendAll(fd, batch) || !reader.readResponses(count, hits, errors)) {
+                ::close(fd);
+                return false;
+            }
+        }
+        ::close(fd);
+        return errors == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Config config = parseArgs(argc, argv);
+    if (!preload(config)) {
+        std::cerr << "cache_bench: preload failed" << std::endl;
+        return 1;
+    }
+
+    Totals totals;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(config.seconds);
+    Timer timer;
+    std::vector<std::thread> clients;
+    for (int i = 0; i < config.threads; i++) {
+        clients.emplace_back(runClient, std::cref(config), i, deadline, std::ref(totals));
+    }
+    for (auto& client : clients) client.join();
+    double seconds = timer.elapsed() / 1000.0;
+
+    uint64_t requests = totals.requests;
+    std::cout << std::fixed << std::setprecision(2)
+              << "requests: " << requests << ", throughput: " << requests / seconds << " req/s"
+              << ", keys/s: " << totals.keysRequested / seconds
+              << ", get hits: " << totals.hits
+              << ", errors: " << totals.errors << std::endl;
+    return totals.errors == 0 ? 0 : 1;
+}
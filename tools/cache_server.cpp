@@ -0,0 +1,97 @@
+#include "../src/LRU/LRUCache.h"
+#include "../src/LFU/LFUCache.h"
+#include "../src/ARC/ArcCache.h"
+#include "../src/Server/CacheServer.h"
+
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <csignal>
+#include <pthread.h>
+
+// 用法: cache_server [--policy lru|lfu|arc] [--capacity N] [--shards N]
+//                    [--host ADDR] [--port N] [--unix PATH] [--threads N]
+// --host "" 关闭 TCP；Ctrl-C 或 SIGTERM 退出
+namespace {
+    struct Config {
+        std::string policy = "lru";
+        size_t capacity = 1 << 20;
+        int shards = 0;
+        CacheSpace::ServerOptions server;
+    };
+
+    void usage(const char* program) {
+        std::cerr << "usage: " << program << " [--policy lru|lfu|arc] [--capacity N] [--shards N]"
+                  << " [--host ADDR] [--port N] [--unix PATH] [--threads N]" << std::endl;
+        std::exit(2);
+    }
+
+    Config parseArgs(int argc, char** argv) {
+        Config config;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) usage(argv[0]);
+            const char* value = argv[++i];
+
+            if (arg == "--policy") config.policy = value;
+            else if (arg == "--capacity") config.capacity = std::strtoull(value, nullptr, 10);
+            else if (arg == "--shards") config.shards = std::atoi(value);
+            else if (arg == "--host") config.server.host = value;
+            else if (arg == "--port") config.server.port = static_cast<uint16_t>(std::atoi(value));
+            else if (arg == "--unix") config.server.unixPath = value;
+            else if (arg == "--threads") config.server.threads = std::strtoull(value, nullptr, 10);
+            else usage(argv[0]);
+        }
+        return config;
+    }
+
+    // 事件循环线程继承屏蔽的信号，由主线程统一等待退出信号
+    template<typename Cache>
+    int serve(Cache& cache, const Config& config) {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+
+        CacheSpace::Cache_Server<Cache> server(cache, config.server);
+        try {
+            server.start();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        std::cout << "cache_server: policy " << config.policy << ", capacity " << config.capacity;
+        if (!config.server.host.empty()) std::cout << ", tcp " << config.server.host << ":" << server.port();
+        if (!config.server.unixPath.empty()) std::cout << ", unix " << config.server.unixPath;
+        std::cout << std::endl;
+
+        int received;
+        sigwait(&signals, &received);
+        server.stop();
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    using Item = std::shared_ptr<const CacheSpace::Memcache::Item>;
+    Config config = parseArgs(argc, argv);
+
+    if (config.policy == "lru") {
+        CacheSpace::Hash_LRU_Cache<std::string, Item> cache(config.capacity, config.shards);
+        return serve(cache, config);
+    }
+    if (config.policy == "lfu") {
+        CacheSpace::Hash_LFU_Cache<std::string, Item> cache(config.capacity, config.shards);
+        return serve(cache, config);
+    }
+    if (config.policy == "arc") {
+        CacheSpace::ARC_Cache<std::string, Item> cache(config.capacity);
+        return serve(cache, config);
+    }
+    usage(argv[0]);
+}
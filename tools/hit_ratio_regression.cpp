@@ -0,0 +1,236 @@
+#include "../src/Timer.h"
+#include "../src/Workload/Workload.h"
+#include "../src/Adaptive/AdaptiveCache.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <functional>
+
+// 命中率回归测试：固定种子的负载 × 各淘汰策略 × 多个容量，结果写入 CSV，
+// 并与保存的基线比较，任一组合的命中率比基线低出 tolerance 以上即返回 1
+// 用法: hit_ratio_regression [--baseline PATH] [--out PATH] [--tolerance R]
+//                            [--ops N] [--seed N] [--update-baseline]
+// --out 默认写到可执行文件所在目录（即构建目录），运行时不会弄脏源码树
+namespace {
+    using namespace CacheSpace;
+
+    struct Config {
+        std::string baseline;
+        std::string out;                // 空: 可执行文件旁的 hit_ratio.csv
+        double tolerance = 0.005;       // 命中率允许的绝对下降
+        uint64_t ops = 50000;
+        uint64_t seed = 1;
+        bool updateBaseline = false;
+    };
+
+    const uint64_t KEYS = 10000;
+    const std::vector<size_t> CAPACITIES = {100, 500, 2000};
+
+    struct WorkloadSpec {
+        std::string name;
+        std::function<std::unique_ptr<Workload>(uint64_t seed)> make;
+    };
+
+    struct Row {
+        std::string workload;
+        std::string policy;
+        size_t capacity;
+        uint64_t accesses;
+        uint64_t hits;
+
+        std::string id() const { return workload + "," + policy + "," + std::to_string(capacity); }
+        double ratio() const { return accesses ? static_cast<double>(hits) / accesses : 0.0; }
+    };
+
+    void usage(const char* program) {
+        std::cerr << "usage: " << program << " [--baseline PATH] [--out PATH] [--tolerance R]"
+                  << " [--ops N] [--seed N] [--update-baseline]" << std::endl;
+        std::exit(2);
+    }
+
+    Config parseArgs(int argc, char** argv) {
+        Config config;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--update-baseline") {
+                config.updateBaseline = true;
+                continue;
+            }
+            if (i + 1 >= argc) usage(argv[0]);
+            const char* value = argv[++i];
+
+            if (arg == "--baseline") config.baseline = value;
+            else if (arg == "--out") config.out = value;
+            else if (arg == "--tolerance") config.tolerance = std::atof(value);
+            else if (arg == "--ops") config.ops = std::strtoull(value, nullptr, 10);
+            else if (arg == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+            else usage(argv[0]);
+        }
+        if (config.updateBaseline && config.baseline.empty()) usage(argv[0]);
+        if (config.out.empty()) {
+            std::string program = argv[0];
+            size_t slash = program.rfind('/');
+            config.out = (slash == std::string::npos ? std::string() : program.substr(0, slash + 1)) + "hit_ratio.csv";
+        }
+        return config;
+    }
+
+    template<typename Generator, typename... Args>
+    WorkloadSpec reads(const std::string& name, Args... args) {
+        return WorkloadSpec{name, [=](uint64_t seed) -> std::unique_ptr<Workload> {
+            return std::make_unique<ReadWorkload>(name, std::make_unique<Generator>(args..., seed));
+        }};
+    }
+
+    std::vector<WorkloadSpec> workloads() {
+        std::vector<WorkloadSpec> specs = {
+            reads<UniformKeys>("uniform", KEYS),
+            reads<ScrambledZipfianKeys>("zipf-0.6", KEYS, 0.6),
+            reads<ScrambledZipfianKeys>("zipf-0.8", KEYS, 0.8),
+            reads<ScrambledZipfianKeys>("zipf-0.99", KEYS, 0.99),
+            reads<ScrambledZipfianKeys>("zipf-1.2", KEYS, 1.2),
+            reads<PhaseShiftKeys>("phase-shift", KEYS, uint64_t(1000), uint64_t(10000), 0.99),
+            {"loop", [](uint64_t) -> std::unique_ptr<Workload> {
+                return std::make_unique<ReadWorkload>("loop", std::make_unique<LoopKeys>(1000));
+            }},
+            // 热点负载中穿插 20% 的一次性顺序扫描
+            {"zipf+scan", [](uint64_t seed) -> std::unique_ptr<Workload> {
+                auto mixed = std::make_unique<MixedKeys>(std::make_unique<ScrambledZipfianKeys>(KEYS, 0.99, seed),
+                                                         std::make_unique<ScanKeys>(KEYS), 0.2, mixHash(seed));
+                return std::make_unique<ReadWorkload>("zipf+scan", std::move(mixed));
+            }},
+        };
+        for (char type : std::string("ABCDEF")) {
+            specs.push_back({std::string("ycsb-") + type, [type](uint64_t seed) -> std::unique_ptr<Workload> {
+                return std::make_unique<YCSBWorkload>(type, KEYS, seed);
+            }});
+        }
+        return specs;
+    }
+
+    // 读穿语义：读未命中后回填；更新与插入直接写入；扫描逐键读取
+    Row replay(const WorkloadSpec& spec, const PolicyChoice& choice, size_t capacity, const Config& config) {
+        auto cache = makePolicy<uint64_t, uint64_t>(choice, capacity);
+        auto workload = spec.make(config.seed);
+        Row row{spec.name, choice.name(), capacity, 0, 0};
+
+        auto read = [&](uint64_t key) {
+            uint64_t value;
+            row.accesses++;
+            if (cache->get(key, value)) row.hits++;
+            else cache->put(key, key);
+        };
+
+        for (uint64_t i = 0; i < config.ops; i++) {
+            Operation op = workload->next();
+            switch (op.type) {
+                case OperationType::Read:
+                    read(op.key);
+                    break;
+                case OperationType::Update:
+                case OperationType::Insert:
+                    cache->put(op.key, op.key);
+                    break;
+                case OperationType::Scan:
+                    for (uint32_t k = 0; k < op.length; k++) read(op.key + k);
+                    break;
+                case OperationType::ReadModifyWrite:
+                    read(op.key);
+                    cache->put(op.key, op.key);
+                    break;
+            }
+        }
+        return row;
+    }
+
+    bool writeCsv(const std::string& path, const std::vector<Row>& rows) {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "workload,policy,capacity,accesses,hits,hit_ratio\n";
+        char ratio[32];
+        for (const auto& row : rows) {
+            std::snprintf(ratio, sizeof(ratio), "%.4f", row.ratio());
+            out << row.id() << "," << row.accesses << "," << row.hits << "," << ratio << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+    // 基线按 "workload,policy,capacity" 索引命中率
+    bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::string line;
+        std::getline(in, line);
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            std::string field;
+            while (std::getline(stream, field, ',')) fields.push_back(field);
+            if (fields.size() != 6) continue;
+            baseline[fields[0] + "," + fields[1] + "," + fields[2]] = std::atof(fields[5].c_str());
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Config config = parseArgs(argc, argv);
+
+    Timer timer;
+    std::vector<Row> rows;
+    auto choices = Adaptive_Cache<uint64_t, uint64_t>::defaultChoices();
+    for (const auto& spec : workloads()) {
+        for (size_t capacity : CAPACITIES) {
+            for (const auto& choice : choices) rows.push_back(replay(spec, choice, capacity, config));
+        }
+    }
+    std::cout << rows.size() << " runs in " << timer.elapsed() << " ms" << std::endl;
+
+    if (!writeCsv(config.out, rows)) {
+        std::cerr << "hit_ratio_regression: cannot write " << config.out << std::endl;
+        return 1;
+    }
+    if (config.updateBaseline) {
+        if (!writeCsv(config.baseline, rows)) {
+            std::cerr << "hit_ratio_regression: cannot write " << config.baseline << std::endl;
+            return 1;
+        }
+        std::cout << "baseline updated: " << config.baseline << std::endl;
+        return 0;
+    }
+    if (config.baseline.empty()) return 0;
+
+    std::map<std::string, double> baseline;
+    if (!readBaseline(config.baseline, baseline)) {
+        std::cerr << "hit_ratio_regression: cannot read " << config.baseline << std::endl;
+        return 1;
+    }
+
+    int regressions = 0, improvements = 0, missing = 0;
+    for (const auto& row : rows) {
+        auto it = baseline.find(row.id());
+        if (it == baseline.end()) {
+            missing++;
+            continue;
+        }
+        double delta = row.ratio() - it->second;
+        if (delta < -config.tolerance) {
+            regressions++;
+            std::printf("REGRESSION %s: %.4f -> %.4f\n", row.id().c_str(), it->second, row.ratio());
+        } else if (delta > config.tolerance) {
+            improvements++;
+            std::printf("improved   %s: %.4f -> %.4f\n", row.id().c_str(), it->second, row.ratio());
+        }
+    }
+    std::cout << rows.size() << " combinations, " << regressions << " regressions, "
+              << improvements << " improvements, " << missing << " not in baseline" << std::endl;
+    if (improvements) std::cout << "rerun with --update-baseline to accept the improvements" << std::endl;
+    return regressions == 0 ? 0 : 1;
+}